@@ -10,6 +10,7 @@
 #include <string>
 #include <functional>
 #include "midi_utility.h"
+#include "midi_in.h"
 
 namespace sykes{
     
@@ -26,9 +27,9 @@ namespace sykes{
     };
     
     class alsa_midi_in
+        : public midi_in
     {
     public:
-        typedef boost::posix_time::ptime ptime;
         alsa_midi_in();
         alsa_midi_in(std::string const& _name);
         ~alsa_midi_in();
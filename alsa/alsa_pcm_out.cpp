@@ -27,11 +27,13 @@ namespace sykes{
         m_worker(),
         m_mutex(),
         m_running_mutex(),
-        m_buffer_mutex()
+        m_buffer_mutex(),
+        m_statistics()
     {
         open_device();
         open_poll();
         set_parameter();
+        m_statistics.set_budget(m_buffer_size, m_sample_rate);
     }
     
     alsa_pcm_out::alsa_pcm_out(std::size_t _sample_rate, std::size_t _buffer_size)
@@ -49,11 +51,13 @@ namespace sykes{
         m_worker(),
         m_mutex(),
         m_running_mutex(),
-        m_buffer_mutex()
+        m_buffer_mutex(),
+        m_statistics()
     {
         open_device();
         open_poll();
         set_parameter();
+        m_statistics.set_budget(m_buffer_size, m_sample_rate);
     }
     
     alsa_pcm_out::~alsa_pcm_out()
@@ -132,6 +136,11 @@ namespace sykes{
         return m_sample_rate;
     }
     
+    pcm_statistics_snapshot alsa_pcm_out::statistics() const
+    {
+        return m_statistics.snapshot();
+    }
+    
     void alsa_pcm_out::set_parameter()
     {
         if(m_handle){
@@ -253,15 +262,10 @@ namespace sykes{
                 if(poll(&m_poll[0], m_poll.size(), alsa_pcm_default::poll_wait) > 0) {
                     for(std::size_t i = 0, sz = m_poll.size(); i < sz; ++i){
                         if(m_poll[i].revents > 0){
-                            if(m_callback) m_callback();
+                            run_callback();
                             {
                                 lock_type lk_buffer(m_buffer_mutex);
-                                if(snd_pcm_writei(m_handle.get(), &m_transfer_buffer_float[0], m_buffer_size)
-                                    < int(m_buffer_size))
-                                {
-                                    THROW_AT_ERROR( snd_pcm_prepare(m_handle.get()) != 0,
-                                        std::runtime_error("alsa_pcm_out::routine_for_float_format()" STRINGIZE(__LINE__)));
-                                }
+                                transfer(&m_transfer_buffer_float[0]);
                             }
                         }
                     }
@@ -284,21 +288,51 @@ namespace sykes{
                 if(poll(&m_poll[0], m_poll.size(), alsa_pcm_default::poll_wait) > 0) {
                     for(std::size_t i = 0, sz = m_poll.size(); i < sz; ++i){
                         if(m_poll[i].revents > 0){
-                            if(m_callback) m_callback();
+                            run_callback();
                             
                             lock_type lk_buffer(m_buffer_mutex);
-                            if(snd_pcm_writei(m_handle.get(), &m_transfer_buffer_short[0], m_buffer_size)
-                                < int(m_buffer_size))
-                            {
-                                THROW_AT_ERROR( snd_pcm_prepare(m_handle.get()) != 0,
-                                    std::runtime_error("alsa_pcm_out::routine_for_short_format()" STRINGIZE(__LINE__)));
-                            }
+                            transfer(&m_transfer_buffer_short[0]);
                         }
                     }
                 }
             }
         }
     }
+    
+    void alsa_pcm_out::run_callback()
+    {
+        if(!m_callback) return;
+        std::uint64_t const begin = pcm_statistics::monotonic_ns();
+        m_callback();
+        m_statistics.record_callback(pcm_statistics::monotonic_ns() - begin);
+    }
+    
+    // a failed write is recorded and recovered from here instead of
+    // throwing out of the worker thread, which used to kill the process.
+    // a short write goes on with the frames left; only a period the
+    // loop gives up on with frames left counts as a short write.
+    void alsa_pcm_out::transfer(void const* _buffer)
+    {
+        unsigned char const* p = static_cast<unsigned char const*>(_buffer);
+        snd_pcm_uframes_t remaining = m_buffer_size;
+        std::size_t failures = 0;
+        while(remaining > 0){
+            snd_pcm_sframes_t const written = snd_pcm_writei(m_handle.get(), p, remaining);
+            if(written > 0){
+                remaining -= snd_pcm_uframes_t(written);
+                p += snd_pcm_frames_to_bytes(m_handle.get(), written);
+                continue;
+            }
+            if(written < 0){
+                if(written == -EPIPE) m_statistics.record_xrun();
+                bool const recovered = (snd_pcm_recover(m_handle.get(), int(written), 1) == 0);
+                m_statistics.record_recovery(recovered);
+                if(!recovered) break;
+            }
+            if(++failures >= alsa_pcm_default::write_attempts) break;
+        }
+        if(remaining > 0) m_statistics.record_short_write();
+    }
 }//----
 
 
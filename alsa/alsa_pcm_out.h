@@ -12,6 +12,7 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 // std
+#include <cerrno>
 #include <cstddef>
 #include <vector>
 #include <memory>
@@ -19,6 +20,9 @@
 #include <cstdint>
 #include <type_traits>
 #include <limits>
+// sykes
+#include "pcm_statistics.h"
+#include "pcm_out.h"
 
 
 namespace sykes{
@@ -30,6 +34,9 @@ namespace sykes{
         static std::size_t const periods = 3;
         static std::size_t const max_periods = 12;
         static int const poll_wait = 1000;
+        // writes of one period that may fail or write nothing
+        // before the rest of it is dropped
+        static std::size_t const write_attempts = 4;
     };
     
     template<typename T>
@@ -50,10 +57,9 @@ namespace sykes{
     };
     
     class alsa_pcm_out
+        : public pcm_out
     {
     public:
-        typedef float buffer_format_type;
-        
         alsa_pcm_out();
         alsa_pcm_out(std::size_t _sample_rate, std::size_t _buffer_size);
         ~alsa_pcm_out();
@@ -67,6 +73,7 @@ namespace sykes{
         std::size_t periods() const;
         std::size_t sample_rate() const;
         void write_buffer(std::vector<buffer_format_type> const& _data);
+        pcm_statistics_snapshot statistics() const;
         
     private:
         typedef boost::recursive_mutex mutex_type;
@@ -90,6 +97,7 @@ namespace sykes{
         mutex_type mutable m_mutex;
         mutex_type mutable m_running_mutex;
         mutex_type mutable m_buffer_mutex;
+        pcm_statistics m_statistics;
         
         void set_parameter();
         void open_device();
@@ -97,6 +105,8 @@ namespace sykes{
         void routine();
         void routine_for_float_format();
         void routine_for_short_format();
+        void run_callback();
+        void transfer(void const* _buffer);
     };
 
 #define SYKES_ALSA_PCM_FORMAT(tp, val) \
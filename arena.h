@@ -0,0 +1,153 @@
+//-----------------------------------------------------------
+//    arena.h
+//-----------------------------------------------------------
+#ifndef CREEK_ARENA_H
+#define CREEK_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+namespace creek
+{
+    //-----------------------------------------------------------
+    //    class arena
+    //        bump allocator over a list of chunks. deallocate does
+    //        nothing, the chunks are released together when the
+    //        arena is destroyed. not thread safe.
+    //-----------------------------------------------------------
+    class arena
+    {
+    public:
+        static std::size_t const default_chunk_size = 4096;
+
+        explicit arena(std::size_t _chunk_size = default_chunk_size)
+            : m_chunk_size(_chunk_size), m_chunks(), m_current(0), m_left(0)
+        {}
+
+        ~arena()
+        {
+            for(std::size_t i = 0; i < m_chunks.size(); ++i)
+                ::operator delete(m_chunks[i]);
+        }
+
+        void* allocate(std::size_t _size, std::size_t _align)
+        {
+            std::size_t const pad = (_align - (reinterpret_cast<std::size_t>(m_current) % _align)) % _align;
+            if(m_current == 0 || pad + _size > m_left){
+                // oversized requests get a chunk of their own
+                std::size_t const size = (_size + _align > m_chunk_size) ? (_size + _align) : m_chunk_size;
+                m_chunks.reserve(m_chunks.size() + 1);
+                m_current = static_cast<char*>(::operator new(size));
+                m_chunks.push_back(m_current);
+                m_left = size;
+                return allocate(_size, _align);
+            }
+            void* p = m_current + pad;
+            m_current += pad + _size;
+            m_left -= pad + _size;
+            return p;
+        }
+
+        std::size_t chunk_count() const
+        { return m_chunks.size(); }
+
+    private:
+        std::size_t m_chunk_size;
+        std::vector<char*> m_chunks;
+        char* m_current;
+        std::size_t m_left;
+
+        arena(arena const&);
+        arena& operator=(arena const&);
+    };
+
+    //-----------------------------------------------------------
+    //    class arena_allocator
+    //        allocator drawing from a shared arena. copies share the
+    //        arena, which lives as long as any copy does, so objects
+    //        made by std::allocate_shared keep their arena alive.
+    //        a default constructed allocator uses the global heap.
+    //-----------------------------------------------------------
+    template<typename Tp>
+    class arena_allocator
+    {
+    public:
+        typedef Tp value_type;
+        typedef Tp* pointer;
+        typedef Tp const* const_pointer;
+        typedef Tp& reference;
+        typedef Tp const& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef arena_allocator<U> other;
+        };
+
+        // containers trade arenas on swap and move
+        typedef std::true_type propagate_on_container_swap;
+        typedef std::true_type propagate_on_container_move_assignment;
+
+        arena_allocator()
+            : m_arena()
+        {}
+
+        explicit arena_allocator(std::shared_ptr<arena> const& _arena)
+            : m_arena(_arena)
+        {}
+
+        template<typename U>
+        arena_allocator(arena_allocator<U> const& _other)
+            : m_arena(_other.get_arena())
+        {}
+
+        pointer allocate(size_type _n, void const* = 0)
+        {
+            if(!m_arena) return static_cast<pointer>(::operator new(_n * sizeof(Tp)));
+            return static_cast<pointer>(m_arena->allocate(_n * sizeof(Tp), alignof(Tp)));
+        }
+
+        void deallocate(pointer _p, size_type)
+        {
+            if(!m_arena) ::operator delete(_p);
+        }
+
+        template<typename U, typename ... Args>
+        void construct(U* _p, Args&& ... _args)
+        {
+            ::new(static_cast<void*>(_p)) U(std::forward<Args>(_args)...);
+        }
+
+        template<typename U>
+        void destroy(U* _p)
+        {
+            _p->~U();
+        }
+
+        size_type max_size() const
+        { return size_type(-1) / sizeof(Tp); }
+
+        std::shared_ptr<arena> const& get_arena() const
+        { return m_arena; }
+
+    private:
+        std::shared_ptr<arena> m_arena;
+    };
+
+    template<typename T1, typename T2>
+    inline bool operator==(arena_allocator<T1> const& _a, arena_allocator<T2> const& _b)
+    { return _a.get_arena() == _b.get_arena(); }
+
+    template<typename T1, typename T2>
+    inline bool operator!=(arena_allocator<T1> const& _a, arena_allocator<T2> const& _b)
+    { return !(_a == _b); }
+}//---- namespace creek
+
+#endif
+
@@ -0,0 +1,131 @@
+//-----------------------------------------------------------
+//    clocked_pcm_out.cpp
+//-----------------------------------------------------------
+#include <time.h>
+#include <cerrno>
+#include <algorithm>
+#include "clocked_pcm_out.h"
+
+namespace sykes{
+
+    clocked_pcm_out::clocked_pcm_out(std::size_t _sample_rate, std::size_t _buffer_size, double _speed)
+        :
+        m_running(false),
+        m_sample_rate(_sample_rate),
+        m_buffer_size(_buffer_size),
+        m_speed(_speed),
+        m_transfer_buffer(_buffer_size * m_channel_count, 0.0),
+        m_callback(),
+        m_worker(),
+        m_mutex(),
+        m_running_mutex(),
+        m_statistics()
+    {
+        m_statistics.set_budget(m_buffer_size, m_sample_rate);
+    }
+
+    clocked_pcm_out::~clocked_pcm_out()
+    {
+        stop();
+    }
+
+    void clocked_pcm_out::start()
+    {
+        lock_type lk(m_mutex);
+        lock_type lk2(m_running_mutex);
+        if(m_running) return;
+
+        m_running = true;
+        m_worker = std::unique_ptr<thread_type>(new thread_type(&clocked_pcm_out::routine, this));
+    }
+
+    void clocked_pcm_out::stop()
+    {
+        {
+            lock_type lk(m_running_mutex);
+            if(!m_running) return;
+            m_running = false;
+        }
+        m_worker->join();
+    }
+
+    void clocked_pcm_out::set_callback(std::function<void(void)> const& _f)
+    {
+        lock_type lk(m_mutex);
+        m_callback = _f;
+    }
+
+    bool clocked_pcm_out::is_running() const
+    {
+        lock_type lk(m_running_mutex);
+        return m_running;
+    }
+
+    std::size_t clocked_pcm_out::buffer_size() const
+    {
+        return m_buffer_size;
+    }
+
+    std::size_t clocked_pcm_out::sample_rate() const
+    {
+        return m_sample_rate;
+    }
+
+    // called from inside the callback on the worker thread
+    void clocked_pcm_out::write_buffer(std::vector<buffer_format_type> const& _data)
+    {
+        std::size_t const size = std::min(m_transfer_buffer.size(), _data.size());
+        std::copy(_data.begin(), _data.begin() + size, m_transfer_buffer.begin());
+    }
+
+    pcm_statistics_snapshot clocked_pcm_out::statistics() const
+    {
+        return m_statistics.snapshot();
+    }
+
+    void clocked_pcm_out::run_callback()
+    {
+        lock_type lk(m_mutex);
+        if(!m_callback) return;
+        std::uint64_t const begin = pcm_statistics::monotonic_ns();
+        m_callback();
+        m_statistics.record_callback(pcm_statistics::monotonic_ns() - begin);
+    }
+
+    void clocked_pcm_out::routine()
+    {
+        std::uint64_t const period = (m_speed > 0.0)
+            ? std::uint64_t(double(m_buffer_size) * 1.0e9 / (double(m_sample_rate) * m_speed))
+            : 0;
+        std::uint64_t deadline = pcm_statistics::monotonic_ns();
+
+        while(1){
+            {
+                lock_type lk(m_running_mutex);
+                if(!m_running) break;
+            }
+
+            if(period != 0){
+                timespec ts;
+                ts.tv_sec = time_t(deadline / 1000000000ULL);
+                ts.tv_nsec = long(deadline % 1000000000ULL);
+                while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR)
+                    ;
+            }
+
+            run_callback();
+            deliver(&m_transfer_buffer[0], m_buffer_size);
+
+            if(period != 0){
+                deadline += period;
+                // more than a whole period late: a sound card would have
+                // run dry here, so count it and start over from now.
+                std::uint64_t const now = pcm_statistics::monotonic_ns();
+                if(now > deadline + period){
+                    m_statistics.record_xrun();
+                    deadline = now;
+                }
+            }
+        }
+    }
+}//----
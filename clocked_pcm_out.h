@@ -0,0 +1,88 @@
+//-----------------------------------------------------------
+//    clocked_pcm_out
+//-----------------------------------------------------------
+#ifndef SYKES_CLOCKED_PCM_OUT_H
+#define SYKES_CLOCKED_PCM_OUT_H
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "pcm_out.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class clocked_pcm_out
+    //        pcm_out driven by the monotonic clock instead of a
+    //        sound card. _speed scales the clock, 0 runs the
+    //        callback back to back as fast as it can.
+    //        derived classes receive every period through deliver().
+    //-----------------------------------------------------------
+    class clocked_pcm_out
+        : public pcm_out
+    {
+    public:
+        clocked_pcm_out(std::size_t _sample_rate, std::size_t _buffer_size, double _speed = 1.0);
+        ~clocked_pcm_out();
+
+        void start();
+        void stop();
+
+        void set_callback(std::function<void(void)> const& _f);
+        bool is_running() const;
+        std::size_t buffer_size() const;
+        std::size_t sample_rate() const;
+        void write_buffer(std::vector<buffer_format_type> const& _data);
+        pcm_statistics_snapshot statistics() const;
+
+    protected:
+        static std::size_t const m_channel_count = 2;
+
+        virtual void deliver(buffer_format_type const* _frames, std::size_t _frame_count) = 0;
+
+    private:
+        typedef boost::recursive_mutex mutex_type;
+        typedef mutex_type::scoped_lock lock_type;
+        typedef boost::thread thread_type;
+
+        bool m_running;
+        std::size_t m_sample_rate;
+        std::size_t m_buffer_size;
+        double m_speed;
+
+        std::vector<buffer_format_type> m_transfer_buffer;
+        std::function<void(void)> m_callback;
+        std::unique_ptr<thread_type> m_worker;
+        mutex_type mutable m_mutex;
+        mutex_type mutable m_running_mutex;
+        pcm_statistics m_statistics;
+
+        void routine();
+        void run_callback();
+    };
+
+    //-----------------------------------------------------------
+    //    class null_pcm_out
+    //        discards everything. used for load tests.
+    //-----------------------------------------------------------
+    class null_pcm_out
+        : public clocked_pcm_out
+    {
+    public:
+        null_pcm_out(std::size_t _sample_rate, std::size_t _buffer_size, double _speed = 1.0)
+            : clocked_pcm_out(_sample_rate, _buffer_size, _speed)
+        {}
+
+        ~null_pcm_out()
+        { stop(); }
+
+    private:
+        void deliver(buffer_format_type const* _frames, std::size_t _frame_count)
+        {}
+    };
+}//----
+#endif
@@ -193,7 +193,7 @@ namespace sykes{
                     return std::get<1>(m_maps).at(command)(splited[1]);
                     break;
                 case 2:
-                    if(std::get<3>(m_maps).count(command) == 0)
+                    if(std::get<2>(m_maps).count(command) == 0)
                         throw command_dispatch_error("nonexistent command");
                     return std::get<2>(m_maps).at(command)(splited[1], splited[2]);
                     break;
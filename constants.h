@@ -20,6 +20,37 @@ namespace TSynth{
         static std::size_t const vco_wave_table_size = 10240;
         static Real const vco_min_frequency = 8.0;
         static Real const vco_max_frequency = 12000.0;
+        // unison: detuned oscillators per SynthVCO and their default
+        // spread in cents
+        static std::size_t const vco_max_unison = 8;
+        static Real const vco_default_detune = 25.0;
+        
+        // user wavetables: samples of one frame in a multi-frame
+        // file and the shortest mip level
+        static std::size_t const wt_frame_size = 2048;
+        static std::size_t const wt_min_level_size = 64;
+        
+        // noise: samples made per refill and the default rate of
+        // the sample and hold
+        static std::size_t const noise_block_size = 64;
+        static Real const noise_default_rate = 1000.0;
+        
+        // lfo: values worked out per block, at most, for the
+        // parameters it drives
+        static std::size_t const lfo_max_points = 65;
+        
+        // sampler: frames of every sample kept decoded and locked
+        // in memory, the rest streams through a ring per voice
+        // filled by the prefetch thread in chunks. a ring has to
+        // outlast a buffer at the highest pitch played
+        static std::size_t const sampler_head_frames = 16384;
+        static std::size_t const sampler_ring_frames = 16384;
+        static std::size_t const sampler_chunk_frames = 1024;
+        
+        // mixer: inputs with a gain of their own, summed four at a
+        // time
+        static std::size_t const mixer_max_inputs = 16;
+        static std::size_t const mixer_lanes = 4;
         
         static std::size_t const vcf_filter_table_size = 10240;
         static Real const vcf_min_cutoff = 200.0;
@@ -31,6 +62,13 @@ namespace TSynth{
         
         static std::size_t const id_root_vca = 0;
         
+        static std::size_t const patch_cache_size = 8;
+        
+        // live parameter changes: ramp length and the step the
+        // ramped values are updated at
+        static std::size_t const param_ramp_samples = 1024;
+        static std::size_t const param_ramp_chunk = 64;
+        
     };
 
 }//---- namespace
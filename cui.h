@@ -5,10 +5,15 @@
 #define CUI_H
 
 #include <iostream>
+#include <iomanip>
 #include <string>
+#include <sstream>
 #include <functional>
+#include <stdexcept>
 #include "command_dispatcher.h"
 #include "synth.h"
+#include "rt_check.h"
+#include "sample_store.h"
 
 namespace TSynth{
     
@@ -18,6 +23,7 @@ namespace TSynth{
         inline Cui(Synth& synth, std::istream& _i, std::ostream& _o)
             : m_synth(synth),
             m_in(_i), m_out(_o),
+            m_part(0),
             m_cmd(MakeCommandDispatcher(synth))
         {
         }
@@ -30,6 +36,8 @@ namespace TSynth{
         Synth& m_synth;
         std::istream& m_in;
         std::ostream& m_out;
+        // part the part commands act on, 0 - 15 for channel 1 - 16
+        std::size_t m_part;
         sykes::command_dispatcher<void> const m_cmd;
         
         inline void Routine()
@@ -55,9 +63,281 @@ namespace TSynth{
                 {
                     throw;
                 }
+                m_synth.Reclaim();
             }
         }
         
+        inline void Stats()
+        {
+            using namespace boost::posix_time;
+            sykes::pcm_statistics_snapshot const s = m_synth.OutputStatistics();
+            std::uint64_t const average = (s.periods != 0) ? (s.total_callback_ns / s.periods) : 0;
+            
+            m_out << "periods: " << s.periods << "\n"
+                << "xruns: " << s.xruns << "\n"
+                << "short writes: " << s.short_writes << "\n"
+                << "recoveries: " << s.recoveries
+                << " (failed: " << s.recovery_failures << ")\n"
+                << "deadline misses: " << s.deadline_misses << "\n"
+                << "callback [us]: budget " << (s.budget_ns / 1000)
+                << ", average " << (average / 1000)
+                << ", max " << (s.max_callback_ns / 1000) << "\n"
+                << "callback / budget:\n";
+            for(std::size_t i = 0; i < s.histogram.size(); ++i){
+                m_out << "  " << std::setw(3) << (i * 10) << "% - ";
+                if(i + 1 < s.histogram.size())
+                    m_out << std::setw(3) << ((i + 1) * 10) << "%";
+                else
+                    m_out << "    ";
+                m_out << ": " << s.histogram[i] << "\n";
+            }
+            for(std::size_t i = 0; i < s.last_xrun_count; ++i){
+                ptime t = from_time_t(std::time_t(s.last_xruns[i] / 1000000))
+                    + microseconds(s.last_xruns[i] % 1000000);
+                m_out << "xrun at " << to_simple_string(t) << "\n";
+            }
+            m_out << "voice kernel: "
+                << (m_synth.VoiceKernel(m_part).empty() ? "generic" : m_synth.VoiceKernel(m_part)) << "\n";
+            PatchCache const& cache = m_synth.GetPatchCache();
+            m_out << "patch cache: " << cache.Size() << " / " << Constants::patch_cache_size
+                << ", hits " << cache.Hits() << ", misses " << cache.Misses() << "\n";
+            m_out << "dropped midi events: " << m_synth.DroppedMidiEvents() << "\n";
+            m_out << "dropped notes: " << m_synth.DroppedNotes() << "\n";
+            m_out << "sampler underruns: " << SampleStream::Underruns() << "\n";
+            m_out.flush();
+        }
+        
+        inline void RtCheck()
+        {
+            if(!sykes::rt_check_enabled){
+                m_out << "rtcheck: not built in (waf configure --rtcheck)" << std::endl;
+                return;
+            }
+            sykes::rt_check_snapshot const s = sykes::rt_check_statistics();
+            m_out << "real-time scopes: " << s.scopes << "\n"
+                << "violations: " << s.total() << "\n";
+            for(std::size_t i = 0; i < sykes::rt_violation_kinds; ++i){
+                m_out << "  " << sykes::rt_violation_name(static_cast<sykes::rt_violation>(i))
+                    << ": " << s.counts[i] << "\n";
+            }
+            m_out.flush();
+        }
+        
+        inline void Profile()
+        {
+            RenderProfile::Snapshot const p = m_synth.Profile();
+            std::size_t const interval = m_synth.ProfileInterval();
+            if(interval == 0)
+                m_out << "profile: off";
+            else
+                m_out << "profile: every " << interval << " blocks";
+            m_out << ", " << p.blocks << " blocks sampled\n";
+            
+            ProfileTicks const mod_total = p.ModTotal();
+            if(mod_total == 0){
+                m_out.flush();
+                return;
+            }
+            m_out << std::fixed << std::setprecision(1);
+            for(std::size_t i = 0; i < p.mods.size(); ++i){
+                if(i != 0) m_out << ", ";
+                m_out << p.mods[i].first << " " << (100.0 * p.mods[i].second / mod_total) << "%";
+            }
+            m_out << "\n";
+            ProfileTicks const voice_total = p.VoiceTotal();
+            for(std::size_t i = 0; i < p.voices.size(); ++i){
+                if(p.voices[i] == 0) continue;
+                m_out << "voice " << std::setw(2) << i << ": "
+                    << std::setw(5) << (100.0 * p.voices[i] / voice_total) << "%\n";
+            }
+            m_out.unsetf(std::ios_base::floatfield);
+            m_out << std::setprecision(6);
+            m_out.flush();
+        }
+        
+        inline void Profile(std::string const& _blocks)
+        {
+            std::istringstream is(_blocks);
+            std::size_t blocks = 0;
+            if(!(is >> blocks) || !(is >> std::ws).eof()){
+                m_out << "profile: not a block count: " << _blocks << std::endl;
+                return;
+            }
+            m_synth.SetProfileInterval(blocks);
+        }
+        
+        inline void Param(std::string const& _path, std::string const& _value)
+        {
+            std::istringstream is(_value);
+            Real value = 0.0;
+            if(!(is >> value) || !(is >> std::ws).eof()){
+                m_out << "param: not a number: " << _value << std::endl;
+                return;
+            }
+            if(!m_synth.SetParameter(m_part, _path, value))
+                m_out << "param: no such parameter: " << _path << std::endl;
+        }
+        
+        inline void Params()
+        {
+            std::vector<std::pair<std::string, Real>> const params = m_synth.Parameters(m_part);
+            for(std::size_t i = 0; i < params.size(); ++i)
+                m_out << params[i].first << " " << params[i].second << "\n";
+            m_out.flush();
+        }
+        
+        inline void ModMap(std::string const& _source, std::string const& _path,
+            std::string const& _min, std::string const& _max)
+        {
+            ModMap(_source, _path, _min, _max, "lin");
+        }
+        
+        inline void ModMap(std::string const& _source, std::string const& _path,
+            std::string const& _min, std::string const& _max, std::string const& _curve)
+        {
+            ModRoute route;
+            route.path = _path;
+            if(!ModSource::FromString(_source, route.source)){
+                m_out << "modmap: unknown source: " << _source << std::endl;
+                return;
+            }
+            std::istringstream min(_min), max(_max);
+            if(!(min >> route.min) || !(min >> std::ws).eof()
+                || !(max >> route.max) || !(max >> std::ws).eof()){
+                m_out << "modmap: not a number: " << _min << " " << _max << std::endl;
+                return;
+            }
+            if(!StringToModCurve(_curve, route.curve)){
+                m_out << "modmap: unknown curve: " << _curve << std::endl;
+                return;
+            }
+            try{
+                m_synth.MapMod(m_part, route);
+            }
+            catch(std::runtime_error const& _err)
+            {
+                m_out << "modmap: " << _err.what() << std::endl;
+            }
+        }
+        
+        inline void ModMap()
+        {
+            std::vector<ModRoute> const routes = m_synth.ModRoutes(m_part);
+            for(std::size_t i = 0; i < routes.size(); ++i){
+                m_out << routes[i].source.ToString() << " " << routes[i].path << " "
+                    << routes[i].min << " " << routes[i].max << " "
+                    << ModCurveName(routes[i].curve) << "\n";
+            }
+            m_out.flush();
+        }
+        
+        inline void ModUnmap(std::string const& _source, std::string const& _path)
+        {
+            ModSource source;
+            if(!ModSource::FromString(_source, source)){
+                m_out << "modunmap: unknown source: " << _source << std::endl;
+                return;
+            }
+            if(!m_synth.UnmapMod(m_part, source, _path))
+                m_out << "modunmap: no such route: " << _source << " " << _path << std::endl;
+        }
+        
+        inline void Compose(std::string const& _str)
+        {
+            // a patch naming a missing file leaves the part as it was
+            try{
+                m_synth.Compose(m_part, _str);
+            }
+            catch(std::runtime_error const& _err)
+            {
+                m_out << "compose: " << _err.what() << std::endl;
+            }
+        }
+        
+        inline void Part()
+        {
+            for(std::size_t p = 0; p < Synth::max_parts; ++p){
+                Synth::PartInfo const info = m_synth.GetPartInfo(p);
+                m_out << ((p == m_part) ? "* " : "  ") << "part " << std::setw(2) << (p + 1) << ": ";
+                if(info.composed){
+                    std::string const& kernel = m_synth.VoiceKernel(p);
+                    m_out << (kernel.empty() ? "generic" : kernel);
+                }else{
+                    m_out << "-";
+                }
+                m_out << ", voices " << info.active << " (reserved " << info.reserved
+                    << ", max " << info.max_voices << "), volume " << info.volume << "\n";
+            }
+            m_out.flush();
+        }
+        
+        inline void Part(std::string const& _part)
+        {
+            std::istringstream is(_part);
+            std::size_t part = 0;
+            if(!(is >> part) || !(is >> std::ws).eof() || part < 1 || part > Synth::max_parts){
+                m_out << "part: not a part from 1 to " << Synth::max_parts << ": " << _part << std::endl;
+                return;
+            }
+            m_part = part - 1;
+        }
+        
+        inline void PartVoices(std::string const& _reserved, std::string const& _max)
+        {
+            std::istringstream reserved_is(_reserved), max_is(_max);
+            std::size_t reserved = 0, max = 0;
+            if(!(reserved_is >> reserved) || !(reserved_is >> std::ws).eof()
+                || !(max_is >> max) || !(max_is >> std::ws).eof()){
+                m_out << "partvoices: not a voice count: " << _reserved << " " << _max << std::endl;
+                return;
+            }
+            try{
+                m_synth.SetPartVoices(m_part, reserved, max);
+            }
+            catch(std::runtime_error const& _err)
+            {
+                m_out << "partvoices: " << _err.what() << std::endl;
+            }
+        }
+        
+        inline void PartVolume(std::string const& _volume)
+        {
+            std::istringstream is(_volume);
+            Real volume = 0.0;
+            if(!(is >> volume) || !(is >> std::ws).eof() || volume < 0.0){
+                m_out << "partvolume: not a volume: " << _volume << std::endl;
+                return;
+            }
+            m_synth.SetPartVolume(m_part, volume);
+        }
+        
+        inline void Crossfade(std::string const& _blocks)
+        {
+            std::istringstream is(_blocks);
+            std::size_t blocks = 0;
+            if(!(is >> blocks) || !(is >> std::ws).eof()){
+                m_out << "crossfade: not a block count: " << _blocks << std::endl;
+                return;
+            }
+            m_synth.SetCrossfade(blocks);
+        }
+        
+        inline void Optimize()
+        {
+            OptimizeResult const nodes = m_synth.PatchNodes(m_part);
+            m_out << "optimize: " << (m_synth.Optimize() ? "on" : "off")
+                << ", nodes " << nodes.before << " -> " << nodes.after << std::endl;
+        }
+        
+        inline void Optimize(std::string const& _switch)
+        {
+            if(_switch != "on" && _switch != "off"){
+                m_out << "optimize: not on or off: " << _switch << std::endl;
+                return;
+            }
+            m_synth.SetOptimize(_switch == "on");
+        }
+        
         inline sykes::command_dispatcher<void>
         MakeCommandDispatcher(Synth& synth)
         {
@@ -70,7 +350,77 @@ namespace TSynth{
                 std::bind(&Synth::Stop, &synth));
             tmp.register_command(
                 "compose",
-                std::bind(&Synth::Compose, &synth, std::placeholders::_1),
+                std::bind(&Cui::Compose, this, std::placeholders::_1),
+                sykes::nocast());
+            tmp.register_command(
+                "part",
+                std::bind(static_cast<void (Cui::*)()>(&Cui::Part), this));
+            tmp.register_command(
+                "part",
+                std::bind(static_cast<void (Cui::*)(std::string const&)>(&Cui::Part),
+                    this, std::placeholders::_1),
+                sykes::nocast());
+            tmp.register_command(
+                "partvoices",
+                std::bind(&Cui::PartVoices, this, std::placeholders::_1, std::placeholders::_2),
+                sykes::nocast(), sykes::nocast());
+            tmp.register_command(
+                "partvolume",
+                std::bind(&Cui::PartVolume, this, std::placeholders::_1),
+                sykes::nocast());
+            tmp.register_command(
+                "stats",
+                std::bind(&Cui::Stats, this));
+            tmp.register_command(
+                "rtcheck",
+                std::bind(&Cui::RtCheck, this));
+            tmp.register_command(
+                "profile",
+                std::bind(static_cast<void (Cui::*)()>(&Cui::Profile), this));
+            tmp.register_command(
+                "profile",
+                std::bind(static_cast<void (Cui::*)(std::string const&)>(&Cui::Profile),
+                    this, std::placeholders::_1),
+                sykes::nocast());
+            tmp.register_command(
+                "param",
+                std::bind(&Cui::Param, this, std::placeholders::_1, std::placeholders::_2),
+                sykes::nocast(), sykes::nocast());
+            tmp.register_command(
+                "params",
+                std::bind(&Cui::Params, this));
+            tmp.register_command(
+                "modmap",
+                std::bind(static_cast<void (Cui::*)()>(&Cui::ModMap), this));
+            tmp.register_command(
+                "modmap",
+                std::bind(static_cast<void (Cui::*)(std::string const&, std::string const&,
+                        std::string const&, std::string const&)>(&Cui::ModMap),
+                    this, std::placeholders::_1, std::placeholders::_2,
+                    std::placeholders::_3, std::placeholders::_4),
+                sykes::nocast(), sykes::nocast(), sykes::nocast(), sykes::nocast());
+            tmp.register_command(
+                "modmap",
+                std::bind(static_cast<void (Cui::*)(std::string const&, std::string const&,
+                        std::string const&, std::string const&, std::string const&)>(&Cui::ModMap),
+                    this, std::placeholders::_1, std::placeholders::_2,
+                    std::placeholders::_3, std::placeholders::_4, std::placeholders::_5),
+                sykes::nocast(), sykes::nocast(), sykes::nocast(), sykes::nocast(), sykes::nocast());
+            tmp.register_command(
+                "modunmap",
+                std::bind(&Cui::ModUnmap, this, std::placeholders::_1, std::placeholders::_2),
+                sykes::nocast(), sykes::nocast());
+            tmp.register_command(
+                "crossfade",
+                std::bind(&Cui::Crossfade, this, std::placeholders::_1),
+                sykes::nocast());
+            tmp.register_command(
+                "optimize",
+                std::bind(static_cast<void (Cui::*)()>(&Cui::Optimize), this));
+            tmp.register_command(
+                "optimize",
+                std::bind(static_cast<void (Cui::*)(std::string const&)>(&Cui::Optimize),
+                    this, std::placeholders::_1),
                 sykes::nocast());
             return tmp;
         }
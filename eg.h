@@ -22,7 +22,55 @@ namespace TSynth{
         SynthEG();
         SynthEG(Real _a, Real _d, Real _s, Real _r);
         
-        Real operator()();
+        inline Real operator()()
+        {
+            switch(GetState()){
+                case EGState::ATTACK:
+                {
+                    if(m_phase < m_attack){
+                        m_last_val = (m_attack_rate * (Real)m_phase);
+                        ++m_phase;
+                        return m_last_val;
+                    }else{
+                        SetState(EGState::DECAY);
+                    }
+                }
+                case EGState::DECAY:
+                {
+                    if(m_phase < m_decay){
+                        Real n1 = m_delta_phase_decay * (Real)m_phase;
+                        m_last_val = (1.0 - m_sustain) * inv_exp_table[std::size_t(n1)] + m_sustain;
+                        ++m_phase;
+                        return m_last_val;
+                    }else{
+                        SetState(EGState::SUSTAIN);
+                    }
+                }
+                case EGState::SUSTAIN:
+                {
+                    m_last_val = m_sustain;
+                    return (m_sustain);
+                }
+                case EGState::RELEASE:
+                {
+                    if(m_phase < m_release){
+                        Real n1 = m_delta_phase_release * (Real)m_phase;
+                        m_last_val = m_release_level * inv_exp_table[std::size_t(n1)];
+                        ++m_phase;
+                        return m_last_val;
+                    }else{
+                        SetState(EGState::OFF);
+                    }
+                }
+                case EGState::OFF:
+                default:
+                {
+                    m_last_val = 0.0;
+                    m_phase = 0;
+                    return 0.0;
+                }
+            }
+        }
         
         inline void SetState(EGState _egs)
         {
@@ -38,7 +86,7 @@ namespace TSynth{
         
         inline void SetAttack(Real _ac)
         {
-            Real tmp = static_cast<Real>(SynthModBase::GetSampleRate()) * _ac;
+            Real tmp = static_cast<Real>(m_sample_rate) * _ac;
             m_attack = static_cast<std::size_t>(tmp);
             if(m_attack != 0)
                 m_attack_rate = 1.0 / tmp;
@@ -48,7 +96,7 @@ namespace TSynth{
         
         inline void SetDecay(Real _dc)
         {
-            Real tmp = static_cast<Real>(SynthModBase::GetSampleRate()) * _dc;
+            Real tmp = static_cast<Real>(m_sample_rate) * _dc;
             m_decay = static_cast<std::size_t>(tmp);
             if(m_decay != 0)
                 m_delta_phase_decay = static_cast<Real>(Constants::inv_exp_table_size) / tmp;
@@ -60,13 +108,15 @@ namespace TSynth{
         {
             if((_sl >= 0.0) && (_sl <= 1.0)){
                 m_sustain = _sl;
-                m_release_level = 1.0 - m_sustain;
+                // a release under way keeps the level it started from
+                if(m_state != EGState::RELEASE)
+                    m_release_level = 1.0 - m_sustain;
             }
         }
         
         inline void SetRelease(Real _rc)
         {
-            Real tmp = static_cast<Real>(SynthModBase::GetSampleRate()) * _rc;
+            Real tmp = static_cast<Real>(m_sample_rate) * _rc;
             m_release = static_cast<std::size_t>(tmp);
             if(m_release != 0)
                 m_delta_phase_release = static_cast<Real>(Constants::inv_exp_table_size) / tmp;
@@ -74,6 +124,31 @@ namespace TSynth{
                 m_delta_phase_release = 0.0;
         }
         
+        // times in seconds
+        inline Real GetAttack() const
+        { return Real(m_attack) / Real(m_sample_rate); }
+        
+        inline Real GetDecay() const
+        { return Real(m_decay) / Real(m_sample_rate); }
+        
+        inline Real GetSustain() const
+        { return m_sustain; }
+        
+        inline Real GetRelease() const
+        { return Real(m_release) / Real(m_sample_rate); }
+        
+        // keeps the times in seconds and the position in the stage
+        inline void SetSampleRate(std::size_t _sr)
+        {
+            if(_sr == m_sample_rate || _sr == 0) return;
+            Real const a = GetAttack(), d = GetDecay(), r = GetRelease();
+            m_phase = static_cast<std::size_t>(Real(m_phase) * Real(_sr) / Real(m_sample_rate));
+            m_sample_rate = _sr;
+            SetAttack(a);
+            SetDecay(d);
+            SetRelease(r);
+        }
+        
         inline void SetADSR(ADSR const& _adsr)
         {
             SetAttack(_adsr.attack);
@@ -84,7 +159,7 @@ namespace TSynth{
     
         inline void MidiReceive(sykes::midi::message _m)
         {
-            switch(sykes::midi::message::status(_m))
+            switch(sykes::midi::message::type(_m))
             {
                 case sykes::midi::channel_voice_message_type::NOTE_ON:
                     SetState(EGState::ATTACK);
@@ -103,6 +178,7 @@ namespace TSynth{
             return (m_state != EGState::OFF);
         }
     private:
+        std::size_t m_sample_rate;
         std::size_t m_phase;
         EGState m_state;
         std::size_t m_attack;
@@ -115,6 +191,45 @@ namespace TSynth{
         Real m_attack_rate;
         Real m_last_val;
     };
+    
+    //-----------------------------------------------------------
+    //    EGParams
+    //        ModParam functions for the envelope of a mod T with
+    //        GetEG(). Used in the parameter lists of the mods.
+    //-----------------------------------------------------------
+    template<typename T>
+    struct EGParams
+    {
+        static Real GetAttack(void const* _m)
+        { return static_cast<T const*>(_m)->GetEG().GetAttack(); }
+        
+        static void SetAttack(void* _m, Real _v)
+        { static_cast<T*>(_m)->GetEG().SetAttack(_v); }
+        
+        static Real GetDecay(void const* _m)
+        { return static_cast<T const*>(_m)->GetEG().GetDecay(); }
+        
+        static void SetDecay(void* _m, Real _v)
+        { static_cast<T*>(_m)->GetEG().SetDecay(_v); }
+        
+        static Real GetSustain(void const* _m)
+        { return static_cast<T const*>(_m)->GetEG().GetSustain(); }
+        
+        static void SetSustain(void* _m, Real _v)
+        { static_cast<T*>(_m)->GetEG().SetSustain(_v); }
+        
+        static Real GetRelease(void const* _m)
+        { return static_cast<T const*>(_m)->GetEG().GetRelease(); }
+        
+        static void SetRelease(void* _m, Real _v)
+        { static_cast<T*>(_m)->GetEG().SetRelease(_v); }
+    };
+    
+#define TSYNTH_EG_PARAMS(cls) \
+    {"attack", &EGParams<cls>::GetAttack, &EGParams<cls>::SetAttack, false}, \
+    {"decay", &EGParams<cls>::GetDecay, &EGParams<cls>::SetDecay, false}, \
+    {"sustain", &EGParams<cls>::GetSustain, &EGParams<cls>::SetSustain, true}, \
+    {"release", &EGParams<cls>::GetRelease, &EGParams<cls>::SetRelease, false}
 }
 #endif
 
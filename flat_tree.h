@@ -0,0 +1,424 @@
+//-----------------------------------------------------------
+//    flat_tree.h
+//-----------------------------------------------------------
+#ifndef CREEK_FLAT_TREE_H
+#define CREEK_FLAT_TREE_H
+
+#include <iterator>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <cstddef>
+#include <assert.h>
+#include "tree.h"
+
+namespace creek
+{
+    //-----------------------------------------------------------
+    //    class flat_tree
+    //        nodes are kept in preorder in one vector. each node
+    //        knows its parent and the end of its subtree, so the
+    //        first child of node i is i + 1 and the next sibling is
+    //        the end of its subtree. preorder is a scan over the
+    //        nodes, postorder a scan over an index array built on
+    //        first use after a change.
+    //        same iterator types as creek::tree; insert and
+    //        append_child take preorder or child iterators.
+    //-----------------------------------------------------------
+    template<typename Tp, typename Allocator = std::allocator<Tp> >
+    class flat_tree
+    {
+    public:
+        typedef flat_tree self_type;
+        typedef Tp value_type;
+        typedef Allocator allocator_type;
+        typedef value_type& reference;
+        typedef value_type const& const_reference;
+        typedef std::size_t size_type;
+        typedef value_type* pointer;
+        typedef value_type const* const_pointer;
+
+        static size_type const npos = size_type(-1);
+
+        struct node_type
+        {
+            value_type m_value;
+            size_type m_parent;
+            size_type m_subtree_end;
+        };
+        typedef typename Allocator::template rebind<node_type>::other node_allocator;
+        typedef typename Allocator::template rebind<size_type>::other index_allocator;
+
+    private:
+        std::vector<node_type, node_allocator> m_nodes;
+        mutable std::vector<size_type, index_allocator> m_postorder;
+        mutable bool m_postorder_valid;
+
+    public:
+        flat_tree()
+            : m_nodes(), m_postorder(), m_postorder_valid(true)
+        {}
+
+        explicit flat_tree(allocator_type const& _alloc)
+            : m_nodes(node_allocator(_alloc)),
+            m_postorder(index_allocator(_alloc)),
+            m_postorder_valid(true)
+        {}
+
+        //---- get_allocator
+        allocator_type get_allocator() const
+        { return allocator_type(m_nodes.get_allocator()); }
+
+        //---- size
+        size_type size() const
+        { return m_nodes.size(); }
+
+        //---- empty
+        bool empty() const
+        { return m_nodes.empty(); }
+
+        //---- operator[]
+        // value of the node at _i in preorder
+        reference operator[](size_type _i)
+        {
+            assert(_i < size());
+            return m_nodes[_i].m_value;
+        }
+        
+        const_reference operator[](size_type _i) const
+        {
+            assert(_i < size());
+            return m_nodes[_i].m_value;
+        }
+
+        //---- reserve
+        void reserve(size_type _n)
+        { m_nodes.reserve(_n); }
+
+        //---- insert
+        // on an empty tree makes the root, otherwise the new node
+        // takes the place of _pos and _pos becomes its only child.
+        template<typename Iterator>
+        Iterator insert(Iterator _pos, value_type const& _val)
+        {
+            static_assert(!std::is_same<typename Iterator::traverse_tag, postorder_tag>::value,
+                "creek::flat_tree::insert()");
+            if(m_nodes.empty()){
+                m_nodes.push_back(node_type{_val, npos, 1});
+                m_postorder_valid = false;
+                return Iterator(this, 0);
+            }
+            size_type const k = _pos.node();
+            assert(k < size());
+            insert_node(k, m_nodes[k].m_parent, _val);
+            m_nodes[k + 1].m_parent = k;
+            m_nodes[k].m_subtree_end = m_nodes[k + 1].m_subtree_end;
+            return Iterator(this, k);
+        }
+
+        //---- append child
+        template<typename Iterator>
+        Iterator append_child(Iterator _pos, value_type const& _val)
+        {
+            static_assert(!std::is_same<typename Iterator::traverse_tag, postorder_tag>::value,
+                "creek::flat_tree::append_child()");
+            size_type const p = _pos.node();
+            assert(p < size());
+            size_type const k = m_nodes[p].m_subtree_end;
+            insert_node(k, p, _val);
+            m_nodes[k].m_subtree_end = k + 1;
+            return Iterator(this, k);
+        }
+
+        //---- clear
+        void clear()
+        {
+            m_nodes.clear();
+            m_postorder.clear();
+            m_postorder_valid = true;
+        }
+
+        //---- swap
+        void swap(self_type& _other)
+        {
+            m_nodes.swap(_other.m_nodes);
+            m_postorder.swap(_other.m_postorder);
+            std::swap(m_postorder_valid, _other.m_postorder_valid);
+        }
+
+    private:
+        //---- insert node
+        // opens a slot at _k under _parent and shifts the indices
+        // behind it. the caller sets the new node's subtree end.
+        void insert_node(size_type _k, size_type _parent, value_type const& _val)
+        {
+            for(size_type i = 0; i < m_nodes.size(); ++i){
+                node_type& n = m_nodes[i];
+                if(n.m_parent != npos && n.m_parent >= _k) ++n.m_parent;
+                if(n.m_subtree_end > _k) ++n.m_subtree_end;
+            }
+            // ancestors whose subtree ended right at _k grow into it,
+            // older siblings ending there do not.
+            for(size_type a = _parent; a != npos; a = m_nodes[a].m_parent){
+                if(m_nodes[a].m_subtree_end == _k) ++m_nodes[a].m_subtree_end;
+            }
+            m_nodes.insert(m_nodes.begin() + _k, node_type{_val, _parent, _k + 1});
+            m_postorder_valid = false;
+        }
+
+        //---- update postorder
+        // a node is finished once the scan leaves its subtree.
+        void update_postorder() const
+        {
+            if(m_postorder_valid) return;
+            m_postorder.clear();
+            m_postorder.reserve(m_nodes.size());
+            std::vector<size_type> open;
+            for(size_type i = 0; i < m_nodes.size(); ++i){
+                while(!open.empty() && m_nodes[open.back()].m_subtree_end <= i){
+                    m_postorder.push_back(open.back());
+                    open.pop_back();
+                }
+                open.push_back(i);
+            }
+            while(!open.empty()){
+                m_postorder.push_back(open.back());
+                open.pop_back();
+            }
+            m_postorder_valid = true;
+        }
+
+    public:
+        //---- iterators
+        template<bool IsConst, typename TraverseTag>
+        class flat_tree_iterator;
+
+        typedef flat_tree_iterator<false, preorder_tag> preorder_iterator;
+        typedef flat_tree_iterator<true, preorder_tag> const_preorder_iterator;
+        typedef flat_tree_iterator<false, postorder_tag> postorder_iterator;
+        typedef flat_tree_iterator<true, postorder_tag> const_postorder_iterator;
+        typedef flat_tree_iterator<false, child_tag> child_iterator;
+        typedef flat_tree_iterator<true, child_tag> const_child_iterator;
+
+        //---- preorder begin end
+        preorder_iterator preorder_begin()
+        { return preorder_iterator(this, 0); }
+
+        preorder_iterator preorder_end()
+        { return preorder_iterator(this, size()); }
+
+        const_preorder_iterator preorder_begin() const
+        { return const_preorder_iterator(this, 0); }
+
+        const_preorder_iterator preorder_end() const
+        { return const_preorder_iterator(this, size()); }
+
+        //---- postorder begin end
+        postorder_iterator postorder_begin()
+        {
+            update_postorder();
+            return postorder_iterator(this, 0);
+        }
+
+        postorder_iterator postorder_end()
+        { return postorder_iterator(this, size()); }
+
+        const_postorder_iterator postorder_begin() const
+        {
+            update_postorder();
+            return const_postorder_iterator(this, 0);
+        }
+
+        const_postorder_iterator postorder_end() const
+        { return const_postorder_iterator(this, size()); }
+
+        //-----------------------------------------------------------
+        //    flat_tree_iterator
+        //        m_pos is the node index for preorder and child
+        //        iterators and the position in the postorder array
+        //        for postorder iterators.
+        //-----------------------------------------------------------
+        template<bool IsConst, typename TraverseTag>
+        class flat_tree_iterator
+        {
+        public:
+            static bool const is_const_iterator = IsConst;
+            typedef flat_tree_iterator self_type;
+            typedef TraverseTag traverse_tag;
+            typedef flat_tree::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef typename
+                conditional<IsConst, value_type const*, value_type*>::type pointer;
+            typedef typename
+                conditional<IsConst, value_type const&, value_type&>::type reference;
+            typedef std::bidirectional_iterator_tag iterator_category;
+
+            typedef flat_tree_iterator<IsConst, child_tag> dual_iterator;
+            typedef typename
+                conditional<IsConst, flat_tree const*, flat_tree*>::type tree_pointer;
+
+        private:
+            tree_pointer m_tree;
+            size_type m_pos;
+            size_type m_parent;   // child iterators only
+
+        public:
+            flat_tree_iterator() : m_tree(), m_pos(), m_parent(npos) {}
+
+            flat_tree_iterator(tree_pointer _tree, size_type _pos)
+                : m_tree(_tree), m_pos(_pos),
+                m_parent((_pos < _tree->size()) ? _tree->m_nodes[_pos].m_parent : npos)
+            {}
+
+            flat_tree_iterator(tree_pointer _tree, size_type _pos, size_type _parent)
+                : m_tree(_tree), m_pos(_pos), m_parent(_parent)
+            {}
+
+            flat_tree_iterator(flat_tree_iterator<false, TraverseTag> const& _other)
+                : m_tree(_other.tree()), m_pos(_other.position()), m_parent(_other.parent_node())
+            {}
+
+            //---- operators
+            reference operator*() const
+            {
+                assert(node() < m_tree->size());
+                return m_tree->m_nodes[node()].m_value;
+            }
+
+            pointer operator->() const
+            {
+                return &(operator*());
+            }
+
+            self_type& operator++()
+            {
+                increment(traverse_tag());
+                return *this;
+            }
+
+            self_type operator++(int)
+            {
+                self_type tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            self_type& operator--()
+            {
+                decrement(traverse_tag());
+                return *this;
+            }
+
+            self_type operator--(int)
+            {
+                self_type tmp(*this);
+                --(*this);
+                return tmp;
+            }
+
+            template<bool B, typename Tag>
+            bool operator==(flat_tree_iterator<B, Tag> const& _other) const
+            {
+                return (node() == _other.node());
+            }
+
+            template<bool B, typename Tag>
+            bool operator!=(flat_tree_iterator<B, Tag> const& _other) const
+            {
+                return (node() != _other.node());
+            }
+
+            //---- node
+            // index of the node in preorder, size() at the end
+            size_type node() const
+            {
+                if(!std::is_same<traverse_tag, postorder_tag>::value) return m_pos;
+                return (m_pos < m_tree->size()) ? m_tree->m_postorder[m_pos] : m_tree->size();
+            }
+
+            size_type position() const
+            { return m_pos; }
+
+            size_type parent_node() const
+            { return m_parent; }
+
+            tree_pointer tree() const
+            { return m_tree; }
+
+            bool has_child() const
+            {
+                size_type const i = node();
+                assert(i < m_tree->size());
+                return (m_tree->m_nodes[i].m_subtree_end != i + 1);
+            }
+
+            flat_tree_iterator<IsConst, preorder_tag> get_parent() const
+            {
+                size_type const i = node();
+                assert(i < m_tree->size());
+                size_type const p = m_tree->m_nodes[i].m_parent;
+                return flat_tree_iterator<IsConst, preorder_tag>(m_tree,
+                    (p == npos) ? m_tree->size() : p);
+            }
+
+            //---- dual_iterator
+            inline dual_iterator begin() const
+            {
+                size_type const i = node();
+                assert(i < m_tree->size());
+                return dual_iterator(m_tree, i + 1, i);
+            }
+
+            inline dual_iterator end() const
+            {
+                size_type const i = node();
+                assert(i < m_tree->size());
+                return dual_iterator(m_tree, m_tree->m_nodes[i].m_subtree_end, i);
+            }
+
+        private:
+            void increment(preorder_tag)
+            {
+                assert(m_pos < m_tree->size());
+                ++m_pos;
+            }
+
+            void increment(postorder_tag)
+            {
+                assert(m_pos < m_tree->size());
+                ++m_pos;
+            }
+
+            void increment(child_tag)
+            {
+                assert(m_pos < m_tree->size());
+                m_pos = m_tree->m_nodes[m_pos].m_subtree_end;
+            }
+
+            void decrement(preorder_tag)
+            {
+                assert(m_pos != 0);
+                --m_pos;
+            }
+
+            void decrement(postorder_tag)
+            {
+                assert(m_pos != 0);
+                --m_pos;
+            }
+
+            // siblings only link forward, walk from the first child
+            void decrement(child_tag)
+            {
+                assert(m_parent != npos && m_pos != m_parent + 1);
+                size_type c = m_parent + 1;
+                while(m_tree->m_nodes[c].m_subtree_end != m_pos)
+                    c = m_tree->m_nodes[c].m_subtree_end;
+                m_pos = c;
+            }
+        };
+    };
+}//---- namespace creek
+
+#endif
+
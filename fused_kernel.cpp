@@ -0,0 +1,166 @@
+//-----------------------------------------------------------
+//    fused_kernel.cpp
+//-----------------------------------------------------------
+#include <iterator>
+#include "fused_kernel.h"
+#include "vco.h"
+#include "vcf.h"
+#include "vca.h"
+#include "mixer.h"
+
+namespace TSynth{
+
+    namespace{
+        //-----------------------------------------------------------
+        //    shape nodes
+        //        Bind checks that the tree node at _it holds the
+        //        expected mod with the expected number of inputs
+        //        and keeps a pointer to it.
+        //-----------------------------------------------------------
+        template<typename Iterator>
+        inline std::ptrdiff_t ChildCount(Iterator _it)
+        {
+            return std::distance(_it.begin(), _it.end());
+        }
+
+        struct VCO
+        {
+            VCO() : mod(0) {}
+
+            inline Real operator()()
+            {
+                return (*mod)();
+            }
+
+            template<typename Iterator>
+            bool Bind(Iterator _it)
+            {
+                mod = (**_it).template As<SynthVCO>();
+                return mod && !_it.has_child();
+            }
+
+            SynthVCO* mod;
+        };
+
+        template<typename In>
+        struct VCF
+        {
+            VCF() : mod(0), in() {}
+
+            inline Real operator()()
+            {
+                return (*mod)(in());
+            }
+
+            template<typename Iterator>
+            bool Bind(Iterator _it)
+            {
+                mod = (**_it).template As<SynthVCF>();
+                return mod && ChildCount(_it) == 1 && in.Bind(_it.begin());
+            }
+
+            SynthVCF* mod;
+            In in;
+        };
+
+        template<typename In>
+        struct VCA
+        {
+            VCA() : mod(0), in() {}
+
+            inline Real operator()()
+            {
+                return (*mod)(in());
+            }
+
+            template<typename Iterator>
+            bool Bind(Iterator _it)
+            {
+                mod = (**_it).template As<SynthVCA>();
+                return mod && ChildCount(_it) == 1 && in.Bind(_it.begin());
+            }
+
+            SynthVCA* mod;
+            In in;
+        };
+
+        template<typename In1, typename In2>
+        struct Mix
+        {
+            Mix() : mod(0), in1(), in2() {}
+
+            inline Real operator()()
+            {
+                return (*mod)(in1(), in2());
+            }
+
+            template<typename Iterator>
+            bool Bind(Iterator _it)
+            {
+                mod = (**_it).template As<Mixer>();
+                if(!mod || ChildCount(_it) != 2) return false;
+                auto child = _it.begin();
+                if(!in1.Bind(child)) return false;
+                ++child;
+                return in2.Bind(child);
+            }
+
+            Mixer* mod;
+            In1 in1;
+            In2 in2;
+        };
+
+        //-----------------------------------------------------------
+        //    Kernel
+        //-----------------------------------------------------------
+        template<typename Shape>
+        class Kernel : public FusedKernel
+        {
+        public:
+            Kernel(Shape const& _shape, char const* _name)
+                : m_shape(_shape), m_name(_name)
+            {}
+
+            void Render(Real* _out, std::size_t _n)
+            {
+                for(std::size_t i = 0; i < _n; ++i)
+                    _out[i] = m_shape();
+            }
+
+            char const* Name() const
+            {
+                return m_name;
+            }
+
+        private:
+            Shape m_shape;
+            char const* m_name;
+        };
+
+        template<typename Shape>
+        FusedKernelPtr TryShape(ModTree& _tree, char const* _name)
+        {
+            Shape shape;
+            if(!shape.Bind(_tree.preorder_begin())) return FusedKernelPtr();
+            // lives next to the mods it points to
+            return std::allocate_shared<Kernel<Shape>>(_tree.get_allocator(), shape, _name);
+        }
+    }
+
+    FusedKernelPtr MakeFusedKernel(ModTree& _tree)
+    {
+        if(_tree.empty()) return FusedKernelPtr();
+
+        FusedKernelPtr kernel;
+        if((kernel = TryShape<VCA<VCO>>(_tree, "SynthVCA(SynthVCO)")))
+            return kernel;
+        if((kernel = TryShape<VCA<VCF<VCO>>>(_tree, "SynthVCA(SynthVCF(SynthVCO))")))
+            return kernel;
+        if((kernel = TryShape<VCA<Mix<VCO, VCO>>>(_tree, "SynthVCA(Mixer(SynthVCO SynthVCO))")))
+            return kernel;
+        if((kernel = TryShape<VCA<VCF<Mix<VCO, VCO>>>>(_tree, "SynthVCA(SynthVCF(Mixer(SynthVCO SynthVCO)))")))
+            return kernel;
+        return kernel;
+    }
+}//---- namespace
+
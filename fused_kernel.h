@@ -0,0 +1,41 @@
+//-----------------------------------------------------------
+//    FusedKernel
+//-----------------------------------------------------------
+#ifndef SYNTH_FUSED_KERNEL_H
+#define SYNTH_FUSED_KERNEL_H
+
+#include <cstddef>
+#include <memory>
+#include "type.h"
+#include "synth_mod_base.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    class FusedKernel
+    //        renders a whole voice in one loop per block. made at
+    //        bind time when the mod tree has one of the shapes in
+    //        fused_kernel.cpp. it calls the mods of the tree
+    //        through plain pointers, so midi and parameter changes
+    //        reach it as they reach the tree.
+    //-----------------------------------------------------------
+    class FusedKernel
+    {
+    public:
+        virtual ~FusedKernel() {}
+
+        virtual void Render(Real* _out, std::size_t _n) = 0;
+
+        // the matched shape, e.g. "SynthVCA(SynthVCO)"
+        virtual char const* Name() const = 0;
+    };
+
+    typedef std::shared_ptr<FusedKernel> FusedKernelPtr;
+
+    // null if no kernel fits the tree, the tree is then run through
+    // its std::function graph
+    FusedKernelPtr MakeFusedKernel(ModTree& _tree);
+}//---- namespace
+
+#endif
+
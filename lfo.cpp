@@ -0,0 +1,133 @@
+//-----------------------------------------------------------
+//    lfo.cpp
+//-----------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include "lfo.h"
+#include "noise.h"
+
+namespace TSynth{
+    TSYNTH_DECLARE_NULLARY_MOD(SynthLFO, (&StringToLfoShape, StoD(), &StringToLfoMode))
+    
+    namespace{
+        ModParam const lfo_params[] = {
+            {"rate", &ModParamGet<SynthLFO, &SynthLFO::GetRate>,
+                &ModParamSet<SynthLFO, &SynthLFO::SetRate>, true}
+        };
+    }
+    
+    ModParamList const SynthLFO::params = {lfo_params, sizeof(lfo_params) / sizeof(lfo_params[0])};
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    SynthLFO::SynthLFO(LfoShape _shape, Real _rate, LfoMode _mode)
+        : m_shape(_shape),
+        m_mode(_mode),
+        m_rate(),
+        m_increment(),
+        m_phase(0.0),
+        m_from(0.0),
+        m_to(0.0),
+        m_key(0),
+        m_counter(0),
+        m_points(),
+        m_count(1),
+        m_samples(1),
+        m_elapsed(0)
+    {
+        SetRate(_rate);
+        Restart();
+    }
+    
+    //-----------------------------------------------------------
+    //    a cycle that ends inside the block draws the next random
+    //    value at once, so the points never miss a step of SH
+    //-----------------------------------------------------------
+    void SynthLFO::Advance(std::size_t _samples, std::size_t _points)
+    {
+        if(_points < 2) _points = 2;
+        if(_points > Constants::lfo_max_points) _points = Constants::lfo_max_points;
+        Real const step = m_increment * Real(_samples) / Real(_points - 1);
+        m_points[0] = Shape();
+        for(std::size_t k = 1; k < _points; ++k){
+            m_phase += step;
+            while(m_phase >= 1.0){
+                m_phase -= 1.0;
+                m_from = m_to;
+                m_to = Random();
+            }
+            m_points[k] = Shape();
+        }
+        m_count = _points;
+        m_samples = (_samples == 0) ? 1 : _samples;
+        m_elapsed = 0;
+    }
+    
+    void SynthLFO::CopyPoints(SynthLFO const& _other)
+    {
+        std::copy(_other.m_points.begin(), _other.m_points.begin() + _other.m_count, m_points.begin());
+        m_count = _other.m_count;
+        m_samples = _other.m_samples;
+        m_elapsed = 0;
+    }
+    
+    //-----------------------------------------------------------
+    //    voices of a free running lfo start at phases of their own
+    //-----------------------------------------------------------
+    void SynthLFO::SetVoice(std::size_t _voice)
+    {
+        m_key = NoiseHash(static_cast<std::uint32_t>(_voice) + 1);
+        m_counter = 0;
+        Restart();
+        if(m_mode == LfoMode::FREE) m_phase = Random() * 0.5 + 0.5;
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthLFO::SetRate(Real _rate)
+    {
+        m_rate = (_rate < 0.0) ? 0.0 : _rate;
+        m_increment = m_rate / Real(SynthModBase::GetSampleRate());
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    Real SynthLFO::Shape() const
+    {
+        switch(m_shape){
+            case LfoShape::TRI:
+                return (m_phase < 0.5) ? (4.0 * m_phase - 1.0) : (3.0 - 4.0 * m_phase);
+            case LfoShape::SQU:
+                return (m_phase < 0.5) ? 1.0 : -1.0;
+            case LfoShape::SH:
+                return m_to;
+            case LfoShape::RND:
+                return m_from + (m_to - m_from) * m_phase;
+            default:
+                return std::sin(2.0 * M_PI * m_phase);
+        }
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    Real SynthLFO::Random()
+    {
+        std::uint32_t const h = NoiseHash(m_counter++ ^ m_key);
+        return Real(static_cast<std::int32_t>(h)) * (1.0 / 2147483648.0);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthLFO::Restart()
+    {
+        m_phase = 0.0;
+        m_from = Random();
+        m_to = Random();
+    }
+}//---- namespace
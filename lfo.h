@@ -0,0 +1,142 @@
+//-----------------------------------------------------------
+//    SynthLFO
+//-----------------------------------------------------------
+#ifndef SYNTH_LFO_H
+#define SYNTH_LFO_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+
+namespace TSynth{
+    //-----------------------------------------------------------
+    //    enum class LfoShape, LfoMode
+    //        FREE: runs on through the notes
+    //        KEY: starts over at every note
+    //        GLOBAL: one for all the voices of the part
+    //-----------------------------------------------------------
+    enum class LfoShape : int
+    {
+        SIN,
+        TRI,
+        SQU,
+        SH,
+        RND
+    };
+    
+    enum class LfoMode : int
+    {
+        FREE,
+        KEY,
+        GLOBAL
+    };
+    
+    inline LfoShape StringToLfoShape(std::string const& _str)
+    {
+        if(_str == "TRI") return LfoShape::TRI;
+        if(_str == "SQU") return LfoShape::SQU;
+        if(_str == "SH") return LfoShape::SH;
+        if(_str == "RND") return LfoShape::RND;
+        return LfoShape::SIN;
+    }
+    
+    inline LfoMode StringToLfoMode(std::string const& _str)
+    {
+        if(_str == "KEY") return LfoMode::KEY;
+        if(_str == "GLOBAL") return LfoMode::GLOBAL;
+        return LfoMode::FREE;
+    }
+    
+    //-----------------------------------------------------------
+    //    class SynthLFO
+    //        a modulation source for the mod matrix (lfo<N>, the
+    //        Nth SynthLFO of the patch). it adds nothing to the
+    //        signal; the ParamTable moves it on once per block and
+    //        takes up to Constants::lfo_max_points values over the
+    //        block, which the parameters it drives step through.
+    //        as the input of a port it gives those values too, at
+    //        the sample it is run at.
+    //        shapes go from -1 to 1. SH holds a random value for a
+    //        cycle, RND glides from one to the next.
+    //-----------------------------------------------------------
+    class SynthLFO : MidiReceivable
+    {
+    public:
+        typedef Real result_type;
+        static std::uint8_t const midi_mask =
+            sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_ON);
+        static ModParamList const params;
+        
+        SynthLFO(LfoShape _shape, Real _rate, LfoMode _mode);
+        
+        inline Real operator()()
+        {
+            ++m_elapsed;
+            return 0.0;
+        }
+        
+        // moves _samples on and keeps _points evenly spaced values
+        // from now to then, 2 <= _points <= Constants::lfo_max_points
+        void Advance(std::size_t _samples, std::size_t _points);
+        
+        // takes the values _other took in its last Advance, for the
+        // voices that play a global lfo
+        void CopyPoints(SynthLFO const& _other);
+        
+        // value _offset samples into the _samples of the last Advance
+        inline Real At(std::size_t _offset, std::size_t _samples) const
+        {
+            std::size_t const k = (_offset >= _samples) ? m_count - 1 : _offset * (m_count - 1) / _samples;
+            return m_points[k];
+        }
+        
+        // value at the sample the lfo is run at next
+        inline Real Current() const
+        { return At(m_elapsed, m_samples); }
+        
+        inline bool IsGlobal() const
+        { return m_mode == LfoMode::GLOBAL; }
+        
+        void SetVoice(std::size_t _voice);
+        
+        // cycles per second
+        void SetRate(Real _rate);
+        
+        inline Real GetRate() const
+        { return m_rate; }
+        
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            if(m_mode != LfoMode::KEY) return;
+            if(sykes::midi::message::type(_m) == sykes::midi::channel_voice_message_type::NOTE_ON)
+                Restart();
+        }
+    private:
+        Real Shape() const;
+        Real Random();
+        void Restart();
+        
+        LfoShape m_shape;
+        LfoMode m_mode;
+        Real m_rate;
+        Real m_increment;
+        Real m_phase;
+        // random values at the start and the end of the cycle
+        Real m_from;
+        Real m_to;
+        std::uint32_t m_key;
+        std::uint32_t m_counter;
+        std::array<Real, Constants::lfo_max_points> m_points;
+        std::size_t m_count;
+        // of the last Advance, and run since
+        std::size_t m_samples;
+        std::size_t m_elapsed;
+        
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
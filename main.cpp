@@ -1,13 +1,35 @@
+
 #include <iostream>
+#include <string>
 #include "synth.h"
 #include "cui.h"
+#include "pcm_out_factory.h"
+#include "midi_in_factory.h"
+
+namespace{
+    // --output=<spec>, see sykes::make_pcm_out()
+    // --midi=<spec>, see sykes::make_midi_in()
+    std::string GetOption(int argc, char** argv, std::string const& _name, std::string const& _default)
+    {
+        std::string const prefix = "--" + _name + "=";
+        for(int i = 1; i < argc; ++i){
+            std::string const arg = argv[i];
+            if(arg.compare(0, prefix.size(), prefix) == 0)
+                return arg.substr(prefix.size());
+        }
+        return _default;
+    }
+}
 
-int main()
+int main(int argc, char** argv)
 {
-    TSynth::Synth synth;
-    TSynth::Cui cui(synth, std::cin, std::cout);
-    
     try{
+        TSynth::Synth synth(sykes::make_pcm_out(
+            GetOption(argc, argv, "output", "alsa"),
+            TSynth::SynthModBase::GetSampleRate(),
+            TSynth::Constants::default_buffer_size),
+            sykes::make_midi_in(GetOption(argc, argv, "midi", "alsa")));
+        TSynth::Cui cui(synth, std::cin, std::cout);
         cui.Run();
     }
     catch(std::exception const& _er){
@@ -18,6 +40,3 @@ int main()
         throw;
     }
 }
-
-
-
@@ -0,0 +1,129 @@
+//-----------------------------------------------------------
+//    mapped_wav.cpp
+//-----------------------------------------------------------
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "mapped_wav.h"
+
+namespace sykes{
+
+    namespace{
+        inline std::uint32_t get_le32(unsigned char const* _p)
+        {
+            return std::uint32_t(_p[0]) | std::uint32_t(_p[1]) << 8
+                | std::uint32_t(_p[2]) << 16 | std::uint32_t(_p[3]) << 24;
+        }
+
+        inline std::uint16_t get_le16(unsigned char const* _p)
+        {
+            return std::uint16_t(_p[0] | _p[1] << 8);
+        }
+    }
+
+    mapped_wav::mapped_wav(std::string const& _path)
+        : m_map(0), m_map_size(0), m_data(0),
+        m_channels(0), m_sample_rate(0), m_frames(0), m_bytes_per_sample(0),
+        m_format(format::pcm16)
+    {
+        int const fd = open(_path.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("mapped_wav: cannot open " + _path);
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size < 12){
+            close(fd);
+            throw std::runtime_error("mapped_wav: not a wav file " + _path);
+        }
+        m_map_size = std::size_t(st.st_size);
+        m_map = mmap(0, m_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(m_map == MAP_FAILED){
+            m_map = 0;
+            throw std::runtime_error("mapped_wav: cannot map " + _path);
+        }
+
+        unsigned char const* const begin = static_cast<unsigned char const*>(m_map);
+        unsigned char const* const end = begin + m_map_size;
+        try{
+            if(std::memcmp(begin, "RIFF", 4) != 0 || std::memcmp(begin + 8, "WAVE", 4) != 0)
+                throw std::runtime_error("mapped_wav: not a wav file " + _path);
+
+            std::size_t data_size = 0;
+            std::uint16_t tag = 0, bits = 0;
+            for(unsigned char const* p = begin + 12; p + 8 <= end; ){
+                std::size_t const size = get_le32(p + 4);
+                unsigned char const* const body = p + 8;
+                if(size > std::size_t(end - body)) break;
+                if(std::memcmp(p, "fmt ", 4) == 0 && size >= 16){
+                    tag = get_le16(body);
+                    m_channels = get_le16(body + 2);
+                    m_sample_rate = get_le32(body + 4);
+                    bits = get_le16(body + 14);
+                    // WAVE_FORMAT_EXTENSIBLE keeps the real tag in the sub format
+                    if(tag == 0xFFFE && size >= 26) tag = get_le16(body + 24);
+                }else if(std::memcmp(p, "data", 4) == 0){
+                    m_data = body;
+                    data_size = size;
+                }
+                p = body + size + (size & 1);
+            }
+
+            if(tag == 1 && bits == 16) m_format = format::pcm16;
+            else if(tag == 1 && bits == 24) m_format = format::pcm24;
+            else if(tag == 1 && bits == 32) m_format = format::pcm32;
+            else if(tag == 3 && bits == 32) m_format = format::float32;
+            else throw std::runtime_error("mapped_wav: unsupported format " + _path);
+            if(!m_data || m_channels == 0)
+                throw std::runtime_error("mapped_wav: no data in " + _path);
+            m_bytes_per_sample = bits / 8;
+            m_frames = data_size / (m_bytes_per_sample * m_channels);
+        }
+        catch(...)
+        {
+            munmap(m_map, m_map_size);
+            throw;
+        }
+    }
+
+    mapped_wav::~mapped_wav()
+    {
+        munmap(m_map, m_map_size);
+    }
+
+    void mapped_wav::read(std::size_t _begin, std::size_t _n, std::size_t _channel, float* _out) const
+    {
+        for(std::size_t i = 0; i < _n; ++i)
+            _out[i] = sample(_begin + i, _channel);
+    }
+
+    void mapped_wav::page_range(std::size_t _begin, std::size_t _n,
+        unsigned char const*& _p, std::size_t& _size) const
+    {
+        std::size_t const page = std::size_t(sysconf(_SC_PAGESIZE));
+        std::size_t const frame_bytes = m_bytes_per_sample * m_channels;
+        std::size_t const first = std::size_t(m_data - static_cast<unsigned char const*>(m_map)) + _begin * frame_bytes;
+        std::size_t const last = std::min(first + _n * frame_bytes, m_map_size);
+        std::size_t const aligned = first / page * page;
+        _p = static_cast<unsigned char const*>(m_map) + aligned;
+        _size = (last > aligned) ? last - aligned : 0;
+    }
+
+    void mapped_wav::will_need(std::size_t _begin, std::size_t _n) const
+    {
+        unsigned char const* p;
+        std::size_t size;
+        page_range(_begin, _n, p, size);
+        if(size) madvise(const_cast<unsigned char*>(p), size, MADV_WILLNEED);
+    }
+
+    void mapped_wav::dont_need(std::size_t _begin, std::size_t _n) const
+    {
+        unsigned char const* p;
+        std::size_t size;
+        page_range(_begin, _n, p, size);
+        if(size) madvise(const_cast<unsigned char*>(p), size, MADV_DONTNEED);
+    }
+}//----
@@ -0,0 +1,95 @@
+//-----------------------------------------------------------
+//    mapped_wav
+//-----------------------------------------------------------
+#ifndef SYKES_MAPPED_WAV_H
+#define SYKES_MAPPED_WAV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class mapped_wav
+    //        a wav file mapped read-only. nothing is read until a
+    //        sample is asked for, so opening a file costs the same
+    //        whatever its length and only the pages touched become
+    //        resident. pcm 16, 24 and 32bit and 32bit float.
+    //        throws std::runtime_error when the file cannot be
+    //        mapped or is not such a wav.
+    //-----------------------------------------------------------
+    class mapped_wav
+    {
+    public:
+        explicit mapped_wav(std::string const& _path);
+        ~mapped_wav();
+
+        inline std::size_t channels() const
+        { return m_channels; }
+
+        inline std::size_t sample_rate() const
+        { return m_sample_rate; }
+
+        inline std::size_t frames() const
+        { return m_frames; }
+
+        // _frame < frames(), _channel < channels(). from -1 to 1
+        inline float sample(std::size_t _frame, std::size_t _channel) const
+        {
+            unsigned char const* p = m_data + (_frame * m_channels + _channel) * m_bytes_per_sample;
+            switch(m_format){
+                case format::pcm16:
+                    return float(std::int16_t(p[0] | (p[1] << 8))) * (1.0f / 32768.0f);
+                case format::pcm24:
+                    return float(std::int32_t(std::uint32_t(p[0]) << 8 | std::uint32_t(p[1]) << 16
+                        | std::uint32_t(p[2]) << 24) >> 8) * (1.0f / 8388608.0f);
+                case format::pcm32:
+                    return float(std::int32_t(std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8
+                        | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24)) * (1.0f / 2147483648.0f);
+                default:
+                {
+                    std::uint32_t const u = std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16
+                        | std::uint32_t(p[3]) << 24;
+                    float f;
+                    __builtin_memcpy(&f, &u, sizeof(f));
+                    return f;
+                }
+            }
+        }
+
+        // _channel of frames [_begin, _begin + _n) into _out
+        void read(std::size_t _begin, std::size_t _n, std::size_t _channel, float* _out) const;
+
+        // asks the kernel to page [_begin, _begin + _n) in ahead of use
+        void will_need(std::size_t _begin, std::size_t _n) const;
+
+        // lets the kernel drop [_begin, _begin + _n) from this
+        // process, a later read pages it in again from the file
+        void dont_need(std::size_t _begin, std::size_t _n) const;
+
+    private:
+        enum class format
+        {
+            pcm16,
+            pcm24,
+            pcm32,
+            float32
+        };
+
+        void* m_map;
+        std::size_t m_map_size;
+        unsigned char const* m_data;
+        std::size_t m_channels;
+        std::size_t m_sample_rate;
+        std::size_t m_frames;
+        std::size_t m_bytes_per_sample;
+        format m_format;
+
+        void page_range(std::size_t _begin, std::size_t _n, unsigned char const*& _p, std::size_t& _size) const;
+
+        mapped_wav(mapped_wav const&);
+        mapped_wav& operator=(mapped_wav const&);
+    };
+}//----
+#endif
@@ -0,0 +1,33 @@
+//-----------------------------------------------------------
+//    midi_in
+//-----------------------------------------------------------
+#ifndef SYKES_MIDI_IN_H
+#define SYKES_MIDI_IN_H
+
+#include <functional>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include "midi_utility.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class midi_in
+    //        interface of a midi input backend. the backend owns
+    //        the worker thread that calls the handler for every
+    //        incoming channel or system message.
+    //-----------------------------------------------------------
+    class midi_in
+    {
+    public:
+        typedef boost::posix_time::ptime ptime;
+        typedef std::function<void(midi::message, ptime)> handler_type;
+
+        virtual ~midi_in(){}
+
+        virtual void start() = 0;
+        virtual void stop() = 0;
+        virtual bool is_running() const = 0;
+        virtual void set_on_midi_event(handler_type const& _f) = 0;
+    };
+}//----
+#endif
@@ -0,0 +1,54 @@
+//-----------------------------------------------------------
+//    midi_in_factory.cpp
+//-----------------------------------------------------------
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include "midi_in_factory.h"
+#include "replay_midi_in.h"
+#include "socket_midi_in.h"
+#ifdef HAVE_ALSA
+#include "alsa/alsa_midi_in.h"
+#endif
+
+namespace sykes{
+
+    std::unique_ptr<midi_in> make_midi_in(std::string const& _spec)
+    {
+        std::string kind = _spec, arg;
+        {
+            std::string::size_type const colon = _spec.find(':');
+            if(colon != std::string::npos){
+                kind = _spec.substr(0, colon);
+                arg = _spec.substr(colon + 1);
+            }
+        }
+        
+        try{
+            if(kind == "alsa"){
+#ifdef HAVE_ALSA
+                return std::unique_ptr<midi_in>(new alsa_midi_in(arg.empty() ? std::string("TSynth") : arg));
+#else
+                throw std::runtime_error("make_midi_in() built without alsa");
+#endif
+            }
+            if((kind == "replay" || kind == "loop") && !arg.empty()){
+                double speed = 1.0;
+                std::string::size_type const at = arg.rfind('@');
+                if(at != std::string::npos){
+                    speed = boost::lexical_cast<double>(arg.substr(at + 1));
+                    arg.erase(at);
+                }
+                return std::unique_ptr<midi_in>(new replay_midi_in(arg, speed, kind == "loop"));
+            }
+            if(kind == "udp" && !arg.empty())
+                return std::unique_ptr<midi_in>(new socket_midi_in(boost::lexical_cast<unsigned short>(arg)));
+            if(kind == "unix" && !arg.empty())
+                return std::unique_ptr<midi_in>(new socket_midi_in(arg));
+        }
+        catch(boost::bad_lexical_cast const&){
+            throw std::runtime_error("make_midi_in() bad number in " + _spec);
+        }
+        
+        throw std::runtime_error("make_midi_in() unknown input " + _spec);
+    }
+}//----
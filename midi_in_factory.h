@@ -0,0 +1,26 @@
+//-----------------------------------------------------------
+//    midi_in_factory
+//-----------------------------------------------------------
+#ifndef SYKES_MIDI_IN_FACTORY_H
+#define SYKES_MIDI_IN_FACTORY_H
+
+#include <memory>
+#include <string>
+#include "midi_in.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    make_midi_in
+    //        _spec is one of
+    //            alsa[:<client name>]
+    //            replay:<path>[@<speed>]
+    //            loop:<path>[@<speed>]
+    //            udp:<port>
+    //            unix:<path>
+    //        replay and loop play an event log (see replay_midi_in),
+    //        loop starts over at the end. "@0" sends without waiting.
+    //-----------------------------------------------------------
+    std::unique_ptr<midi_in> make_midi_in(std::string const& _spec);
+}//----
+#endif
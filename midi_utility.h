@@ -16,12 +16,17 @@ namespace midi{
     {
         std::uint32_t data;
         
+        // channel 0 - 15 of a channel message
         inline static std::uint8_t channel(message _m)
-        { return static_cast<std::uint8_t>(_m.data & 0xFF); }
+        { return static_cast<std::uint8_t>(_m.data & 0x0F); }
         
         inline static std::uint8_t status(message _m)
         { return static_cast<std::uint8_t>(_m.data & 0xFF); }
         
+        // status without the channel, compares with CVMT
+        inline static std::uint8_t type(message _m)
+        { return static_cast<std::uint8_t>(_m.data & 0xF0); }
+        
         inline static std::uint8_t data1(message _m)
         { return static_cast<std::uint8_t>((_m.data >> 8) & 0xFF); }
         
@@ -69,6 +74,16 @@ namespace midi{
     };
     typedef system_message_type SMT;
     
+    // messages are routed by the upper nibble of the status byte:
+    // 0 - 6 for the channel voice messages, 7 for system messages
+    std::size_t const message_kind_count = 8;
+    
+    inline std::size_t message_kind(std::uint8_t _stat)
+    { return (_stat >> 4) & 0x7; }
+    
+    inline constexpr std::uint8_t message_kind_bit(std::uint8_t _stat)
+    { return static_cast<std::uint8_t>(1u << ((_stat >> 4) & 0x7)); }
+    
     inline bool is_channel_message(message _m)
     {
         std::uint8_t stat = message::status(_m);
@@ -85,7 +100,7 @@ namespace midi{
     {
         std::uint32_t i =
             ((_d2 << 16) & 0xFF0000) |
-            ((_d2 << 8) & 0x00FF00) |
+            ((_d1 << 8) & 0x00FF00) |
             (_stat & 0x0000FF); 
         return message{i};
     }
@@ -99,6 +114,36 @@ namespace midi{
         return message{i};
     }
     
+    // length in bytes of a message starting with the status byte _stat,
+    // 0 for system exclusive whose length is not fixed
+    inline std::size_t message_length(std::uint8_t _stat)
+    {
+        switch(_stat & 0xF0){
+            case CVMT::NOTE_OFF:
+            case CVMT::NOTE_ON:
+            case CVMT::POLYPHONIC_PRESSURE:
+            case CVMT::CONTROL_CHANGE:
+            case CVMT::PITCH_BEND:
+                return 3;
+            case CVMT::PROGRAM_CHANGE:
+            case CVMT::CHANNEL_PRESSURE:
+                return 2;
+            default:
+                break;
+        }
+        switch(_stat){
+            case SMT::SYSTEM_EXCLUSIVE:
+                return 0;
+            case SMT::SONG_POSITION:
+                return 3;
+            case 0xF1: // mtc quarter frame
+            case SMT::SONG_SELECT:
+                return 2;
+            default:
+                return 1;
+        }
+    }
+    
     inline std::uint8_t calc_note_number(double _f)
     {
         if(_f <= note_table[0]) return 0;
@@ -1,27 +1,64 @@
 //-----------------------------------------------------------
-//    Mixer
+//    mixer.cpp
 //-----------------------------------------------------------
-#include "type.h"
-#include "synth_mod.h"
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include "mixer.h"
 
 namespace TSynth{
+    TSYNTH_DECLARE_MIX_MOD(Mixer, ())
+    
+    namespace{
+        // Mixer[<g0>,<g1>,...] next to Mixer
+        std::string const mixer_gains_key =
+            SynthModFactory::RegisterMod("Mixer", AModFactory<MixMod<Mixer>>(),
+                std::make_tuple(sykes::nocast()));
+        
+#define TSYNTH_MIXER_GAIN(i) \
+        {"gain" #i, &ModParamGet<Mixer, &Mixer::GetGain<i>>, \
+            &ModParamSet<Mixer, &Mixer::SetGain<i>>, true}
+        
+        ModParam const mixer_params[] = {
+            TSYNTH_MIXER_GAIN(0), TSYNTH_MIXER_GAIN(1), TSYNTH_MIXER_GAIN(2), TSYNTH_MIXER_GAIN(3),
+            TSYNTH_MIXER_GAIN(4), TSYNTH_MIXER_GAIN(5), TSYNTH_MIXER_GAIN(6), TSYNTH_MIXER_GAIN(7),
+            TSYNTH_MIXER_GAIN(8), TSYNTH_MIXER_GAIN(9), TSYNTH_MIXER_GAIN(10), TSYNTH_MIXER_GAIN(11),
+            TSYNTH_MIXER_GAIN(12), TSYNTH_MIXER_GAIN(13), TSYNTH_MIXER_GAIN(14), TSYNTH_MIXER_GAIN(15)
+        };
+        
+#undef TSYNTH_MIXER_GAIN
+        
+        static_assert(sizeof(mixer_params) / sizeof(mixer_params[0]) == Mixer::max_inputs,
+            "TSynth::Mixer needs a gain parameter per input");
+        static_assert(Mixer::max_inputs % Constants::mixer_lanes == 0,
+            "TSynth::Mixer inputs must fill whole lanes");
+    }
+    
+    ModParamList const Mixer::params = {mixer_params, sizeof(mixer_params) / sizeof(mixer_params[0])};
+    
     //-----------------------------------------------------------
-    //    class Mixer
+    //    
     //-----------------------------------------------------------
-    class Mixer
+    Mixer::Mixer()
     {
-    public:
-	    typedef Real result_type;
-        Mixer(){}
-        
-        inline Real operator()(Real _in1, Real _in2) const
-        {
-            return (_in1 + _in2);
+        m_gains.fill(1.0);
+    }
+    
+    Mixer::Mixer(std::string const& _gains)
+    {
+        m_gains.fill(1.0);
+        std::size_t i = 0;
+        std::string::size_type begin = 0;
+        while(begin <= _gains.size()){
+            std::string::size_type end = _gains.find(',', begin);
+            if(end == std::string::npos) end = _gains.size();
+            if(i >= max_inputs)
+                throw std::runtime_error("Mixer: more gains than inputs");
+            try{
+                m_gains[i++] = boost::lexical_cast<Real>(_gains.substr(begin, end - begin));
+            }catch(boost::bad_lexical_cast const&){
+                throw std::runtime_error("Mixer: bad gain: " + _gains);
+            }
+            begin = end + 1;
         }
-    private:
-        TSYNTH_USE_AS_MOD
-    };
-
-    TSYNTH_DECLARE_BINARY_MOD(Mixer, ())
+    }
 }//---- namespace
-
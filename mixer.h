@@ -0,0 +1,68 @@
+//-----------------------------------------------------------
+//    Mixer
+//-----------------------------------------------------------
+#ifndef SYNTH_MIXER_H
+#define SYNTH_MIXER_H
+
+#include <array>
+#include <string>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+
+namespace TSynth{
+    //-----------------------------------------------------------
+    //    class Mixer
+    //        sum of its inputs, each times a gain of its own.
+    //        the gains are given as Mixer[<g0>,<g1>,...], 1 for
+    //        the inputs without one, and are the parameters
+    //        gain0 to gain15.
+    //-----------------------------------------------------------
+    class Mixer
+    {
+    public:
+	    typedef Real result_type;
+        static std::size_t const max_inputs = Constants::mixer_max_inputs;
+        static ModParamList const params;
+        
+        Mixer();
+        explicit Mixer(std::string const& _gains);
+        
+        inline Real operator()(Real _in1, Real _in2) const
+        {
+            return m_gains[0] * _in1 + m_gains[1] * _in2;
+        }
+        
+        // _n inputs, a multiple of Constants::mixer_lanes. the lanes
+        // are summed side by side, which the compiler turns into
+        // vector instructions
+        inline Real Mix(Real const* _in, std::size_t _n) const
+        {
+            std::size_t const lanes = Constants::mixer_lanes;
+            Real sum[lanes] = {};
+            for(std::size_t i = 0; i < _n; i += lanes){
+                for(std::size_t k = 0; k < lanes; ++k)
+                    sum[k] += m_gains[i + k] * _in[i + k];
+            }
+            Real r = 0.0;
+            for(std::size_t k = 0; k < lanes; ++k)
+                r += sum[k];
+            return r;
+        }
+        
+        template<std::size_t I>
+        inline Real GetGain() const
+        { return m_gains[I]; }
+        
+        template<std::size_t I>
+        inline void SetGain(Real _gain)
+        { m_gains[I] = _gain; }
+        
+    private:
+        std::array<Real, max_inputs> m_gains;
+        
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
@@ -74,9 +74,17 @@ namespace TSynth{
     std::string const cls::tsynth_mod_key = \
         SynthModFactory::RegisterMod(#cls, AModFactory<UnaryMod<cls>>(), std::make_tuple cast_funcs);
 
+#define TSYNTH_DECLARE_PULL_MOD(cls, cast_funcs) \
+    std::string const cls::tsynth_mod_key = \
+        SynthModFactory::RegisterMod(#cls, AModFactory<PullMod<cls>>(), std::make_tuple cast_funcs);
+
 #define TSYNTH_DECLARE_BINARY_MOD(cls, cast_funcs) \
     std::string const cls::tsynth_mod_key = \
         SynthModFactory::RegisterMod(#cls, AModFactory<BinaryMod<cls>>(), std::make_tuple cast_funcs);
+
+#define TSYNTH_DECLARE_MIX_MOD(cls, cast_funcs) \
+    std::string const cls::tsynth_mod_key = \
+        SynthModFactory::RegisterMod(#cls, AModFactory<MixMod<cls>>(), std::make_tuple cast_funcs);
 }//---- namespace
 #endif
 
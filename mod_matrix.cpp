@@ -0,0 +1,163 @@
+//-----------------------------------------------------------
+//    mod_matrix.cpp
+//-----------------------------------------------------------
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "mod_matrix.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    ModSource
+    //-----------------------------------------------------------
+    bool ModSource::FromString(std::string const& _str, ModSource& _source)
+    {
+        if(_str == "bend"){
+            _source = ModSource{ModSourceKind::BEND, 0};
+            return true;
+        }
+        if(_str == "pressure"){
+            _source = ModSource{ModSourceKind::PRESSURE, 0};
+            return true;
+        }
+        if(_str == "polypressure"){
+            _source = ModSource{ModSourceKind::POLY_PRESSURE, 0};
+            return true;
+        }
+        if(_str.compare(0, 2, "cc") == 0 && _str.size() > 2 && _str.size() <= 5){
+            char* end = 0;
+            long const n = std::strtol(_str.c_str() + 2, &end, 10);
+            if(*end != '\0' || n < 0 || n > 127) return false;
+            _source = ModSource{ModSourceKind::CC, static_cast<std::uint8_t>(n)};
+            return true;
+        }
+        if(_str.compare(0, 3, "lfo") == 0 && _str.size() > 3 && _str.size() <= 6){
+            char* end = 0;
+            long const n = std::strtol(_str.c_str() + 3, &end, 10);
+            if(*end != '\0' || n < 0 || n > 127) return false;
+            _source = ModSource{ModSourceKind::LFO, static_cast<std::uint8_t>(n)};
+            return true;
+        }
+        return false;
+    }
+
+    std::string ModSource::ToString() const
+    {
+        switch(kind){
+            case ModSourceKind::CC:
+            {
+                std::ostringstream os;
+                os << "cc" << int(number);
+                return os.str();
+            }
+            case ModSourceKind::LFO:
+            {
+                std::ostringstream os;
+                os << "lfo" << int(number);
+                return os.str();
+            }
+            case ModSourceKind::BEND: return "bend";
+            case ModSourceKind::PRESSURE: return "pressure";
+            case ModSourceKind::POLY_PRESSURE: return "polypressure";
+            default: return "none";
+        }
+    }
+
+    //-----------------------------------------------------------
+    //    ModCurve
+    //-----------------------------------------------------------
+    bool StringToModCurve(std::string const& _str, ModCurve& _curve)
+    {
+        if(_str == "lin") _curve = ModCurve::LIN;
+        else if(_str == "exp") _curve = ModCurve::EXP;
+        else if(_str == "quad") _curve = ModCurve::QUAD;
+        else return false;
+        return true;
+    }
+
+    char const* ModCurveName(ModCurve _curve)
+    {
+        switch(_curve){
+            case ModCurve::EXP: return "exp";
+            case ModCurve::QUAD: return "quad";
+            default: return "lin";
+        }
+    }
+
+    //-----------------------------------------------------------
+    //    ModRoute
+    //-----------------------------------------------------------
+    Real ModRoute::Scale(Real _x) const
+    {
+        switch(curve){
+            case ModCurve::EXP:
+                if(min > 0.0 && max > 0.0)
+                    return min * std::pow(max / min, _x);
+                return min + (max - min) * _x;
+            case ModCurve::QUAD:
+                return min + (max - min) * _x * _x;
+            default:
+                return min + (max - min) * _x;
+        }
+    }
+
+    //-----------------------------------------------------------
+    //    ModSources
+    //-----------------------------------------------------------
+    ModSources::ModSources()
+        : m_cc(), m_poly_pressure(), m_bend(0x2000), m_pressure(0)
+    {
+        for(std::size_t i = 0; i < m_cc.size(); ++i){
+            m_cc[i].store(0, std::memory_order_relaxed);
+            m_poly_pressure[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool ModSources::Receive(sykes::midi::message _m)
+    {
+        using namespace sykes::midi;
+        std::uint8_t const d1 = message::data1(_m) & 0x7F;
+        std::uint8_t const d2 = message::data2(_m) & 0x7F;
+        switch(message::type(_m)){
+            case CVMT::CONTROL_CHANGE:
+                m_cc[d1].store(d2, std::memory_order_relaxed);
+                return true;
+            case CVMT::PITCH_BEND:
+                m_bend.store(static_cast<std::uint16_t>((d2 << 7) | d1), std::memory_order_relaxed);
+                return true;
+            case CVMT::CHANNEL_PRESSURE:
+                m_pressure.store(d1, std::memory_order_relaxed);
+                return true;
+            case CVMT::POLYPHONIC_PRESSURE:
+                m_poly_pressure[d1].store(d2, std::memory_order_relaxed);
+                return true;
+            case CVMT::NOTE_ON:
+                // a new note starts without the pressure of the last one
+                m_poly_pressure[d1].store(0, std::memory_order_relaxed);
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    Real ModSources::Value(ModSource const& _source, std::uint8_t _note) const
+    {
+        switch(_source.kind){
+            case ModSourceKind::CC:
+                return m_cc[_source.number & 0x7F].load(std::memory_order_relaxed) / 127.0;
+            case ModSourceKind::BEND:
+            {
+                // 0x2000 is the exact middle
+                Real const x = 0.5 + (Real(m_bend.load(std::memory_order_relaxed)) - 8192.0) / 16382.0;
+                return (x < 0.0) ? 0.0 : x;
+            }
+            case ModSourceKind::PRESSURE:
+                return m_pressure.load(std::memory_order_relaxed) / 127.0;
+            case ModSourceKind::POLY_PRESSURE:
+                return m_poly_pressure[_note & 0x7F].load(std::memory_order_relaxed) / 127.0;
+            default:
+                return 0.0;
+        }
+    }
+}//---- namespace
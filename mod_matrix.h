@@ -0,0 +1,109 @@
+//-----------------------------------------------------------
+//    mod matrix
+//-----------------------------------------------------------
+#ifndef SYNTH_MOD_MATRIX_H
+#define SYNTH_MOD_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <string>
+#include "type.h"
+#include "midi_utility.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    ModSource
+    //        cc<0-127>, bend, pressure, polypressure or
+    //        lfo<0-127>, the SynthLFO of that ordinal in the patch
+    //-----------------------------------------------------------
+    enum class ModSourceKind : int
+    {
+        NONE,
+        CC,
+        BEND,
+        PRESSURE,
+        POLY_PRESSURE,
+        LFO
+    };
+
+    struct ModSource
+    {
+        ModSourceKind kind;
+        std::uint8_t number;    // controller number for CC, ordinal for LFO
+
+        // false for an unknown name
+        static bool FromString(std::string const& _str, ModSource& _source);
+        std::string ToString() const;
+
+        bool operator==(ModSource const& _other) const
+        { return kind == _other.kind && number == _other.number; }
+    };
+
+    //-----------------------------------------------------------
+    //    ModCurve
+    //        lin: min + (max - min) x
+    //        exp: min (max / min)^x, lin unless min and max are
+    //             positive. for frequencies and times
+    //        quad: min + (max - min) x^2
+    //-----------------------------------------------------------
+    enum class ModCurve : int
+    {
+        LIN,
+        EXP,
+        QUAD
+    };
+
+    bool StringToModCurve(std::string const& _str, ModCurve& _curve);
+    char const* ModCurveName(ModCurve _curve);
+
+    //-----------------------------------------------------------
+    //    ModRoute
+    //        one entry of the matrix: a source driving a parameter
+    //        (see ParamTable) between min and max
+    //-----------------------------------------------------------
+    struct ModRoute
+    {
+        ModSource source;
+        std::string path;
+        Real min;
+        Real max;
+        ModCurve curve;
+
+        // _x from 0 to 1
+        Real Scale(Real _x) const;
+    };
+
+    //-----------------------------------------------------------
+    //    class ModSources
+    //        latest value of every source. written by the midi
+    //        thread, read by the audio thread once per block, so
+    //        any number of messages between two blocks costs the
+    //        render the same.
+    //-----------------------------------------------------------
+    class ModSources
+    {
+    public:
+        ModSources();
+
+        // midi thread. true if the message is a source message
+        bool Receive(sykes::midi::message _m);
+
+        // from 0 to 1, bend rests at 0.5. _note for polypressure.
+        // an LFO is not a midi source, the ParamTable reads it
+        Real Value(ModSource const& _source, std::uint8_t _note) const;
+
+    private:
+        std::array<std::atomic<std::uint8_t>, 128> m_cc;
+        std::array<std::atomic<std::uint8_t>, 128> m_poly_pressure;
+        std::atomic<std::uint16_t> m_bend;
+        std::atomic<std::uint8_t> m_pressure;
+
+        ModSources(ModSources const&);
+        ModSources& operator=(ModSources const&);
+    };
+}//---- namespace
+
+#endif
@@ -6,6 +6,9 @@
 #include "synth_mod_base.h"
 #include "mod_factory.h"
 #include "eg.h"
+#include "oversample.h"
+#include "lfo.h"
+#include "vco.h"
 #include "parse.h"
 
 namespace TSynth{
@@ -13,10 +16,54 @@ namespace TSynth{
     
     MonoSynth::MonoSynth()
             : m_mod_tree(),
-            m_function(&_Zero) {}
-        
+            m_function(&_Zero),
+            m_profiled_function(&_Zero),
+            m_optimized() {}
+    
+    MonoSynth::MonoSynth(ModAllocator const& _alloc)
+            : m_mod_tree(_alloc),
+            m_function(&_Zero),
+            m_profiled_function(&_Zero),
+            m_optimized() {}
+    
+    MonoSynth::MonoSynth(MonoSynth const& _other)
+            : m_mod_tree(_other.m_mod_tree),
+            m_function(_other.m_function),
+            m_root_vca(_other.m_root_vca),
+            m_midi_routes(_other.m_midi_routes),
+            m_kernel(_other.m_kernel),
+            m_profiled_function(_other.m_profiled_function),
+            m_node_profiles(_other.m_node_profiles),
+            m_links(_other.m_links),
+            m_port_bases(_other.m_port_bases),
+            m_optimized(_other.m_optimized),
+            m_right(_other.m_right) {}
+    
+    MonoSynth::MonoSynth(MonoSynth&& _other)
+            : m_mod_tree(),
+            m_function(&_Zero),
+            m_profiled_function(&_Zero),
+            m_optimized()
+    {
+        Swap(_other);
+    }
+    
     MonoSynth::~MonoSynth(){}
     
+    MonoSynth& MonoSynth::operator=(MonoSynth const& _other)
+    {
+        MonoSynth tmp(_other);
+        Swap(tmp);
+        return *this;
+    }
+    
+    // takes over the other's tree together with its arena
+    MonoSynth& MonoSynth::operator=(MonoSynth&& _other)
+    {
+        Swap(_other);
+        return *this;
+    }
+    
     void MonoSynth::BindModsInTree()
     {
         if(!CheckTree()) throw std::runtime_error("parse error");
@@ -26,9 +73,73 @@ namespace TSynth{
         }else{
             m_mod_tree.insert(m_mod_tree.preorder_begin(), SynthModFactory::Create("SynthVCA 0.1 0.02 0.1 0.4 0.2"));
             m_root_vca = *(m_mod_tree.preorder_begin());
+            if(m_links){
+                std::shared_ptr<PatchLinks> links = std::make_shared<PatchLinks>(*m_links);
+                links->InsertRoot();
+                m_links = links;
+            }
+        }
+        
+        // mods under an Oversample run at its rate, nested ones at
+        // the product
+        {
+            std::vector<std::size_t> rates(m_mod_tree.size());
+            for(auto it = m_mod_tree.preorder_begin(), end = m_mod_tree.preorder_end(); it != end; ++it){
+                auto const parent = it.get_parent();
+                std::size_t rate = SynthModBase::GetSampleRate();
+                if(parent != end){
+                    rate = rates[parent.node()];
+                    if(Oversample const* oversample = (**parent).As<Oversample>())
+                        rate *= oversample->Factor();
+                }
+                rates[it.node()] = rate;
+                (**it).SetModSampleRate(rate);
+                // a node run ahead is run once per sample of the voice
+                if(m_links && m_links->ahead[it.node()] && rate != SynthModBase::GetSampleRate())
+                    throw std::runtime_error("a $name or a port cannot be under an Oversample");
+            }
         }
         
-        creek::tree<std::function<Real(void)>> func_tree;
+        m_port_bases.reset();
+        if(m_links){
+            m_port_bases = std::make_shared<std::vector<PortBase>>();
+            for(auto it = m_mod_tree.preorder_begin(), end = m_mod_tree.preorder_end(); it != end; ++it){
+                if(!m_links->IsPort(it.node())) continue;
+                auto const parent = it.get_parent();
+                std::size_t const param = m_links->ports[it.node()].param;
+                m_port_bases->push_back(PortBase{parent.node(), param, (**parent).GetParam(param)});
+            }
+        }
+        
+        m_function = MakeFunctionGraph(0);
+        
+        m_node_profiles = std::make_shared<std::vector<NodeProfile>>(m_mod_tree.size());
+        {
+            std::vector<NodeProfile>& nodes = *m_node_profiles;
+            std::size_t i = 0;
+            for(auto it = m_mod_tree.preorder_begin(), end = m_mod_tree.preorder_end(); it != end; ++it, ++i){
+                auto const parent = it.get_parent();
+                // a node run ahead is not part of its parent's time
+                bool const ahead = (m_links && m_links->ahead[i]);
+                nodes[i] = NodeProfile{&(**it).Name(),
+                    (parent == m_mod_tree.preorder_end() || ahead) ? ModTree::npos : parent.node(), 0};
+            }
+        }
+        m_profiled_function = MakeFunctionGraph(m_node_profiles.get());
+        
+        BindMidiRoutes();
+        // the kernels know plain trees only
+        m_kernel = (m_links) ? FusedKernelPtr() : MakeFusedKernel(m_mod_tree);
+    }
+    
+    // the std::function graph of the tree, every node wrapped in a
+    // TimedFunction when _nodes is given
+    std::function<Real(void)> MonoSynth::MakeFunctionGraph(std::vector<NodeProfile>* _nodes)
+    {
+        if(m_links) return MakeLinkedGraph(_nodes);
+        
+        FunctionTree func_tree;
+        func_tree.reserve(m_mod_tree.size());
         {
             auto it_mod = m_mod_tree.preorder_begin();
             auto end_mod = m_mod_tree.preorder_end();
@@ -52,38 +163,169 @@ namespace TSynth{
             auto it_func = func_tree.postorder_begin();
             while(it_mod != end_mod){
                 (*it_func) = (**it_mod).MakeFunction(it_func.begin(), it_func.end());
+                if(_nodes) (*it_func) = TimedFunction(*it_func, &(*_nodes)[it_mod.node()]);
                 ++it_mod;
                 ++it_func;
             }
+        }
+        return *(func_tree.preorder_begin());
+    }
+    
+    // the graph of a patch with links. a node is made in postorder
+    // from the functions of its signal inputs, its ports left out;
+    // a node run ahead becomes a PatchGraph node and every place of
+    // it, its own and those of its $names, reads its value.
+    std::function<Real(void)> MonoSynth::MakeLinkedGraph(std::vector<NodeProfile>* _nodes)
+    {
+        PatchLinks const& links = *m_links;
+        PatchGraph graph(m_mod_tree.size());
+        std::vector<std::function<Real(void)>> functions(m_mod_tree.size());
+        
+        for(auto it_mod = m_mod_tree.postorder_begin(), end_mod = m_mod_tree.postorder_end(); it_mod != end_mod; ++it_mod){
+            std::size_t const i = it_mod.node();
+            std::function<Real(void)> function;
+            if(links.refs[i] != PatchLinks::npos){
+                function = PatchValue{graph.ValueOf(links.refs[i])};
+            }else{
+                FunctionTree inputs;
+                auto const it_func = inputs.insert(inputs.preorder_begin(), std::function<Real(void)>());
+                for(auto it_child = it_mod.begin(), end_child = it_mod.end(); it_child != end_child; ++it_child){
+                    if(!links.IsPort(it_child.node()))
+                        inputs.append_child(it_func, functions[it_child.node()]);
+                }
+                function = (**it_mod).MakeFunction(it_func.begin(), it_func.end());
+            }
+            if(_nodes) function = TimedFunction(function, &(*_nodes)[i]);
             
-            m_function = *(func_tree.preorder_begin());
+            if(links.ahead[i]){
+                graph.AddNode(PatchGraph::Node{function, i, (**it_mod).As<SynthLFO>()});
+                functions[i] = PatchValue{graph.ValueOf(i)};
+            }else{
+                functions[i] = function;
+            }
+        }
+        
+        std::size_t k = 0;
+        for(auto it = m_mod_tree.preorder_begin(), end = m_mod_tree.preorder_end(); it != end; ++it){
+            std::size_t const i = it.node();
+            if(!links.IsPort(i)) continue;
+            SynthModBase& parent = **(it.get_parent());
+            std::size_t const param = links.ports[i].param;
+            graph.AddPort(PatchGraph::Port{i, &parent, param, &(*m_port_bases)[k++].value, links.ports[i].depth});
+        }
+        
+        graph.SetRoot(functions[0]);
+        return graph;
+    }
+    
+    void MonoSynth::SetParam(std::size_t _node, std::size_t _param, Real _value)
+    {
+        bool ported = false;
+        if(m_port_bases){
+            std::vector<PortBase>& bases = *m_port_bases;
+            for(std::size_t k = 0; k < bases.size(); ++k){
+                if(bases[k].node != _node || bases[k].param != _param) continue;
+                bases[k].value = _value;
+                ported = true;
+            }
+        }
+        if(!ported) m_mod_tree[_node]->SetParam(_param, _value);
+        if(m_right) m_right->SetParam(_node, _param, _value);
+    }
+    
+    void MonoSynth::Render(Real* _out, std::size_t _n)
+    {
+        if(m_kernel){
+            m_kernel->Render(_out, _n);
+            return;
+        }
+        for(std::size_t i = 0; i < _n; ++i)
+            _out[i] = m_function();
+    }
+    
+    // also for voices with a fused kernel; the mods are the same and
+    // so is the output, only the per-node times come from the graph.
+    void MonoSynth::RenderProfiled(Real* _out, std::size_t _n, RenderProfile& _profile, std::size_t _voice)
+    {
+        if(!m_node_profiles){
+            Render(_out, _n);
+            return;
+        }
+        std::vector<NodeProfile>& nodes = *m_node_profiles;
+        for(std::size_t i = 0; i < nodes.size(); ++i)
+            nodes[i].ticks = 0;
+        
+        for(std::size_t i = 0; i < _n; ++i)
+            _out[i] = m_profiled_function();
+        
+        // inputs come after their node in preorder, so a node still has
+        // its inclusive time when it is reached and gives it to its parent
+        for(std::size_t i = 0; i < nodes.size(); ++i){
+            NodeProfile const& node = nodes[i];
+            if(node.parent != ModTree::npos)
+                nodes[node.parent].ticks -= node.ticks;
+            else
+                _profile.AddVoice(_voice, node.ticks);
+        }
+        for(std::size_t i = 0; i < nodes.size(); ++i)
+            _profile.AddMod(nodes[i].name, nodes[i].ticks);
+    }
+    
+    char const* MonoSynth::KernelName() const
+    {
+        return (m_kernel) ? m_kernel->Name() : 0;
+    }
+    
+    void MonoSynth::BindMidiRoutes()
+    {
+        for(std::size_t k = 0; k < m_midi_routes.size(); ++k)
+            m_midi_routes[k].clear();
+        
+        for(auto it = m_mod_tree.preorder_begin(), end = m_mod_tree.preorder_end(); it != end; ++it){
+            std::uint8_t const mask = (**it).MidiMask();
+            if(mask == 0) continue;
+            MidiRoute const route = (**it).GetMidiRoute();
+            for(std::size_t k = 0; k < m_midi_routes.size(); ++k){
+                if(mask & (1u << k)) m_midi_routes[k].push_back(route);
+            }
         }
     }
     
-    void MonoSynth::ComposeMonoSynthFromString(std::string const& _str)
+    bool MonoSynth::ComposeMonoSynthFromString(std::string const& _str, bool _optimize)
     {
-        if(Parse(_str, m_mod_tree)){
+        PatchLinks links;
+        if(Parse(_str, m_mod_tree, links)){
+            m_optimized = OptimizeResult{m_mod_tree.size(), m_mod_tree.size()};
+            if(_optimize) m_optimized = OptimizePatch(m_mod_tree, links);
+            if(links.Empty()) m_links.reset();
+            else m_links = std::make_shared<PatchLinks const>(links);
             BindModsInTree();
+            SplitStereo();
+            return true;
         }
+        return false;
     }
     
     MonoSynth MonoSynth::Clone() const
     {
-        // copy mod tree
-        MonoSynth tmp;
+        // copy mod tree. every clone gets an arena of its own, so the
+        // mods of a voice sit together and go away together.
+        ModAllocator const alloc(std::make_shared<creek::arena>());
+        MonoSynth tmp(alloc);
+        tmp.m_mod_tree.reserve(m_mod_tree.size());
         {
             auto it = (*this).m_mod_tree.preorder_begin();
             auto end = (*this).m_mod_tree.preorder_end();
             auto it_copy = tmp.m_mod_tree.preorder_begin();
             if(it != end){
-                it_copy = tmp.m_mod_tree.insert(it_copy, (**it).Clone());
+                it_copy = tmp.m_mod_tree.insert(it_copy, (**it).Clone(alloc));
                 //tmp.m_mod_map.insert(MapType::value_type(m_mod_map.right.at(*it), *it_copy));
             }
             while(it != end){
                 auto it_child = it.begin();
                 auto end_child = it.end();
                 while(it_child != end_child){
-                    auto ch = tmp.m_mod_tree.append_child(it_copy, (**it_child).Clone());
+                    auto ch = tmp.m_mod_tree.append_child(it_copy, (**it_child).Clone(alloc));
                     //tmp.m_mod_map.insert(MapType::value_type(m_mod_map.right.at(*it_child), *ch));
                     ++it_child;
                 }
@@ -92,35 +334,77 @@ namespace TSynth{
             }
         }
         
+        tmp.m_links = m_links;
+        tmp.m_optimized = m_optimized;
         tmp.BindModsInTree();
+        if(m_right) tmp.m_right = std::make_shared<MonoSynth>(m_right->Clone());
         return tmp;
     }
     
+    // a unison spread over the stereo field is rendered through the
+    // whole patch once per side, the filters and envelopes after it
+    // being mono. a patch without one stays a single voice.
+    void MonoSynth::SplitStereo()
+    {
+        m_right.reset();
+        bool stereo = false;
+        for(std::size_t i = 0; i < m_mod_tree.size(); ++i){
+            SynthVCO const* const vco = m_mod_tree[i]->As<SynthVCO>();
+            if(vco && vco->IsStereo()) stereo = true;
+        }
+        if(!stereo) return;
+        
+        for(std::size_t i = 0; i < m_mod_tree.size(); ++i){
+            if(SynthVCO* const vco = m_mod_tree[i]->As<SynthVCO>())
+                vco->SetChannel(SynthVCO::Channel::LEFT);
+        }
+        std::shared_ptr<MonoSynth> right = std::make_shared<MonoSynth>(Clone());
+        for(std::size_t i = 0; i < right->m_mod_tree.size(); ++i){
+            if(SynthVCO* const vco = right->m_mod_tree[i]->As<SynthVCO>())
+                vco->SetChannel(SynthVCO::Channel::RIGHT);
+        }
+        m_right = right;
+    }
+    
     void MonoSynth::Clear()
     {
         m_mod_tree.clear();
         m_function = &_Zero;
         m_root_vca.reset();
+        for(std::size_t k = 0; k < m_midi_routes.size(); ++k)
+            m_midi_routes[k].clear();
+        m_kernel.reset();
+        m_profiled_function = &_Zero;
+        m_node_profiles.reset();
+        m_links.reset();
+        m_port_bases.reset();
+        m_optimized = OptimizeResult();
+        m_right.reset();
     }
     
     bool MonoSynth::CheckTree() const
     {
-        creek::tree<SynthModBasePtr>::const_preorder_iterator curr = m_mod_tree.preorder_begin();
-        creek::tree<SynthModBasePtr>::const_preorder_iterator end = m_mod_tree.preorder_end();
+        ConstIterator curr = m_mod_tree.preorder_begin();
+        ConstIterator end = m_mod_tree.preorder_end();
         
         if(curr == end) return false;
         while(curr != end){
+            // ports are not inputs of the signal
+            bool has_input = false;
+            for(auto it = curr.begin(), it_end = curr.end(); it != it_end; ++it){
+                if(!m_links || !m_links->IsPort(it.node())) has_input = true;
+            }
             auto modtype = (**curr).GetType();
             switch(modtype)
             {
                 case SynthModType::NULLARY:
-                    if(curr.has_child()) return false;
+                    if(has_input) return false;
                     break;
                 case SynthModType::UNARY:
-                    if(!curr.has_child()) return false;
+                    if(!has_input) return false;
                     break;
                 case SynthModType::BINARY:
-                    if(!curr.has_child()) return false;
+                    if(!has_input) return false;
                     break;
             };
             ++curr;
@@ -149,12 +433,11 @@ namespace TSynth{
     
     void MonoSynth::MidiReceive(sykes::midi::message _m)
     {
-        auto curr = m_mod_tree.preorder_begin(), end = m_mod_tree.preorder_end();
-        
-        while(curr != end){
-            (**curr).MidiReceive(_m);
-            ++curr;
-        }
+        std::vector<MidiRoute> const& routes =
+            m_midi_routes[sykes::midi::message_kind(sykes::midi::message::status(_m))];
+        for(std::size_t i = 0, n = routes.size(); i < n; ++i)
+            routes[i](_m);
+        if(m_right) m_right->MidiReceive(_m);
     }
     
     void MonoSynth::Swap(MonoSynth& _other)
@@ -162,6 +445,14 @@ namespace TSynth{
         m_mod_tree.swap(_other.m_mod_tree);
         m_function.swap(_other.m_function);
         m_root_vca.swap(_other.m_root_vca);
+        m_midi_routes.swap(_other.m_midi_routes);
+        m_kernel.swap(_other.m_kernel);
+        m_profiled_function.swap(_other.m_profiled_function);
+        m_node_profiles.swap(_other.m_node_profiles);
+        m_links.swap(_other.m_links);
+        m_port_bases.swap(_other.m_port_bases);
+        std::swap(m_optimized, _other.m_optimized);
+        m_right.swap(_other.m_right);
     }
 }//---- namespace
 
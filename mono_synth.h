@@ -4,10 +4,16 @@
 #ifndef MONO_SYNTH_H
 #define MONO_SYNTH_H
 
+#include <array>
+#include <vector>
 #include "type.h"
-#include "tree.h"
+#include "flat_tree.h"
 #include "midi_utility.h"
 #include "synth_mod_base.h"
+#include "fused_kernel.h"
+#include "profile.h"
+#include "patch_graph.h"
+#include "optimize.h"
 
 namespace TSynth{
     class SynthModBase;
@@ -18,18 +24,39 @@ namespace TSynth{
     {
     public:
         typedef std::shared_ptr<SynthModBase> SynthModBasePtr;
-        typedef creek::tree<SynthModBasePtr>::preorder_iterator Iterator;
-        typedef creek::tree<SynthModBasePtr>::const_preorder_iterator ConstIterator;
+        typedef ModTree::preorder_iterator Iterator;
+        typedef ModTree::const_preorder_iterator ConstIterator;
         typedef int IdType;
         
         MonoSynth();
+        explicit MonoSynth(ModAllocator const& _alloc);
+        MonoSynth(MonoSynth const& _other);
+        MonoSynth(MonoSynth&& _other);
         ~MonoSynth();
         
+        MonoSynth& operator=(MonoSynth const& _other);
+        MonoSynth& operator=(MonoSynth&& _other);
+        
         inline Real operator()() const
         {
             return m_function();
         }
         
+        // one block, through the fused kernel when the tree has one
+        void Render(Real* _out, std::size_t _n);
+        
+        // one block through the timed copy of the graph. adds the time
+        // of every node, without its inputs, to _profile under the
+        // mod's name and the time of the whole voice under _voice.
+        void RenderProfiled(Real* _out, std::size_t _n, RenderProfile& _profile, std::size_t _voice);
+        
+        // name of the fused kernel, 0 for the generic graph
+        char const* KernelName() const;
+        
+        // nodes of the patch as composed and after OptimizePatch
+        inline OptimizeResult Optimized() const
+        { return m_optimized; }
+        
         void MidiReceive(sykes::midi::message _m);
         
         Iterator Insert(Iterator _it, IdType _id, SynthModBasePtr _mod);
@@ -52,6 +79,34 @@ namespace TSynth{
         inline ConstIterator End() const
         { return m_mod_tree.preorder_end(); }
         
+        // mod of the node at _node in preorder
+        inline SynthModBase& ModAt(std::size_t _node)
+        { return *m_mod_tree[_node]; }
+        
+        inline SynthModBase const& ModAt(std::size_t _node) const
+        { return *m_mod_tree[_node]; }
+        
+        inline std::size_t ModCount() const
+        { return m_mod_tree.size(); }
+        
+        // sets parameter _param of the node at _node, or moves the
+        // base of the ports that drive it
+        void SetParam(std::size_t _node, std::size_t _param, Real _value);
+        
+        // tells every mod which voice it plays in
+        inline void SetVoice(std::size_t _voice)
+        {
+            for(std::size_t i = 0; i < m_mod_tree.size(); ++i)
+                m_mod_tree[i]->SetModVoice(_voice);
+            if(m_right) m_right->SetVoice(_voice);
+        }
+        
+        // the right channel of a patch composed with a spread unison,
+        // a twin of this voice that gets the same midi and parameters
+        // while this one plays the left. null for a mono patch
+        inline MonoSynth* Right() const
+        { return m_right.get(); }
+        
         bool CheckTree() const;
         
         inline void Clear();
@@ -64,15 +119,33 @@ namespace TSynth{
         }
     private:
         //typedef boost::bimaps::bimap<IdType, SynthModBasePtr> MapType;
-        creek::tree<SynthModBasePtr> m_mod_tree;
+        ModTree m_mod_tree;
         //MapType m_mod_map;
         std::function<Real(void)> m_function;
         SynthModBasePtr m_root_vca;
+        // receivers per message kind, in preorder
+        std::array<std::vector<MidiRoute>, sykes::midi::message_kind_count> m_midi_routes;
+        FusedKernelPtr m_kernel;
+        // same graph with every node timed, one NodeProfile per node in preorder
+        std::function<Real(void)> m_profiled_function;
+        std::shared_ptr<std::vector<NodeProfile>> m_node_profiles;
+        // $names and ports of the patch, null if it has none
+        PatchLinksPtr m_links;
+        // the bases of the ports, shared by both graphs of the voice
+        PortBasesPtr m_port_bases;
+        OptimizeResult m_optimized;
+        std::shared_ptr<MonoSynth> m_right;
+        
+        void BindMidiRoutes();
+        void SplitStereo();
+        std::function<Real(void)> MakeFunctionGraph(std::vector<NodeProfile>* _nodes);
+        std::function<Real(void)> MakeLinkedGraph(std::vector<NodeProfile>* _nodes);
         
         
     public:
         void BindModsInTree();
-        void ComposeMonoSynthFromString(std::string const& _str);
+        // runs OptimizePatch between parsing and binding if _optimize
+        bool ComposeMonoSynthFromString(std::string const& _str, bool _optimize = true);
         MonoSynth Clone() const;
     };
 }//---- namespace
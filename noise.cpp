@@ -0,0 +1,165 @@
+//-----------------------------------------------------------
+//    noise.cpp
+//-----------------------------------------------------------
+
+#include "noise.h"
+
+namespace TSynth{
+    TSYNTH_DECLARE_NULLARY_MOD(SynthNoise, (&StringToNoiseType, StoD()))
+    
+    namespace{
+        // SynthNoise[<type>] next to SynthNoise[<type> <rate>]
+        std::string const noise_type_only_key =
+            SynthModFactory::RegisterMod("SynthNoise", AModFactory<NullaryMod<SynthNoise>>(),
+                std::make_tuple(&StringToNoiseType));
+        
+        ModParam const noise_params[] = {
+            {"rate", &ModParamGet<SynthNoise, &SynthNoise::GetRate>,
+                &ModParamSet<SynthNoise, &SynthNoise::SetRate>, true},
+            {"seed", &ModParamGet<SynthNoise, &SynthNoise::GetSeed>,
+                &ModParamSet<SynthNoise, &SynthNoise::SetSeed>, false}
+        };
+        
+        // scales the pink filter to the level of the white noise
+        Real const pink_gain = 0.3;
+    }
+    
+    ModParamList const SynthNoise::params = {noise_params, sizeof(noise_params) / sizeof(noise_params[0])};
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    SynthNoise::SynthNoise(NoiseType _type)
+        : m_type(_type),
+        m_rate(Constants::noise_default_rate),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_seed(0),
+        m_voice(0),
+        m_key(0),
+        m_counter(0),
+        m_block(),
+        m_index(0),
+        m_pink(),
+        m_hold(0.0),
+        m_hold_phase(0.0),
+        m_hold_step(0.0)
+    {
+        SetRate(m_rate);
+        Reseed();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    SynthNoise::SynthNoise(NoiseType _type, Real _rate)
+        : m_type(_type),
+        m_rate(_rate),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_seed(0),
+        m_voice(0),
+        m_key(0),
+        m_counter(0),
+        m_block(),
+        m_index(0),
+        m_pink(),
+        m_hold(0.0),
+        m_hold_phase(0.0),
+        m_hold_step(0.0)
+    {
+        SetRate(m_rate);
+        Reseed();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthNoise::SetSampleRate(std::size_t _sr)
+    {
+        if(_sr == 0) return;
+        m_sample_rate = _sr;
+        SetRate(m_rate);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthNoise::SetVoice(std::size_t _voice)
+    {
+        m_voice = _voice;
+        Reseed();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthNoise::SetRate(Real _rate)
+    {
+        m_rate = (_rate < 0.0) ? 0.0 : _rate;
+        m_hold_step = m_rate / Real(m_sample_rate);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthNoise::SetSeed(Real _seed)
+    {
+        m_seed = (_seed < 0.0) ? 0 : static_cast<std::uint32_t>(_seed);
+        Reseed();
+    }
+    
+    //-----------------------------------------------------------
+    //    starts the sequence of the seed and the voice over
+    //-----------------------------------------------------------
+    void SynthNoise::Reseed()
+    {
+        m_key = NoiseHash(m_seed * 0x9e3779b9U + NoiseHash(static_cast<std::uint32_t>(m_voice) + 1));
+        m_counter = 0;
+        m_index = Constants::noise_block_size;
+        m_pink.fill(0.0);
+        m_hold = 0.0;
+        m_hold_phase = 1.0;
+    }
+    
+    //-----------------------------------------------------------
+    //    the white block is a plain loop over independent hashes
+    //    the compiler turns into vector code; the pink filter and
+    //    the hold then run over it once.
+    //    pink: Paul Kellet's economy filter, within 0.6dB of
+    //    -3dB/oct above 10Hz
+    //-----------------------------------------------------------
+    void SynthNoise::Refill()
+    {
+        std::size_t const n = Constants::noise_block_size;
+        Real const scale = 1.0 / 2147483648.0;
+        for(std::size_t j = 0; j < n; ++j){
+            std::uint32_t const h = NoiseHash((m_counter + static_cast<std::uint32_t>(j)) ^ m_key);
+            m_block[j] = Real(static_cast<std::int32_t>(h)) * scale;
+        }
+        m_counter += static_cast<std::uint32_t>(n);
+        m_index = 0;
+        
+        switch(m_type){
+            case NoiseType::PINK:
+                for(std::size_t j = 0; j < n; ++j){
+                    Real const w = m_block[j];
+                    m_pink[0] = 0.99765 * m_pink[0] + w * 0.0990460;
+                    m_pink[1] = 0.96300 * m_pink[1] + w * 0.2965164;
+                    m_pink[2] = 0.57000 * m_pink[2] + w * 1.0526913;
+                    m_block[j] = (m_pink[0] + m_pink[1] + m_pink[2] + w * 0.1848) * pink_gain;
+                }
+                return;
+            case NoiseType::SH:
+                for(std::size_t j = 0; j < n; ++j){
+                    m_hold_phase += m_hold_step;
+                    if(m_hold_phase >= 1.0){
+                        m_hold_phase -= 1.0;
+                        m_hold = m_block[j];
+                    }
+                    m_block[j] = m_hold;
+                }
+                return;
+            default:
+                return;
+        }
+    }
+}//---- namespace
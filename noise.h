@@ -0,0 +1,111 @@
+//-----------------------------------------------------------
+//    SynthNoise
+//-----------------------------------------------------------
+#ifndef SYNTH_NOISE_H
+#define SYNTH_NOISE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+
+namespace TSynth{
+    //-----------------------------------------------------------
+    //    enum class NoiseType
+    //-----------------------------------------------------------
+    enum class NoiseType : int
+    {
+        WHITE,
+        PINK,
+        SH
+    };
+    
+    inline NoiseType StringToNoiseType(std::string const& _str)
+    {
+        if(_str == "PINK") return NoiseType::PINK;
+        if(_str == "SH") return NoiseType::SH;
+        return NoiseType::WHITE;
+    }
+    
+    //-----------------------------------------------------------
+    //    NoiseHash
+    //        a 32bit integer hash with good avalanche. the noise
+    //        is the hash of a counter, so any sample can be made
+    //        on its own and a block of them has no dependencies.
+    //-----------------------------------------------------------
+    inline std::uint32_t NoiseHash(std::uint32_t _x)
+    {
+        _x ^= _x >> 16;
+        _x *= 0x7feb352dU;
+        _x ^= _x >> 15;
+        _x *= 0x846ca68bU;
+        _x ^= _x >> 16;
+        return _x;
+    }
+    
+    //-----------------------------------------------------------
+    //    class SynthNoise
+    //        white, pink (white through a three pole filter) or
+    //        white held at rate. samples are made
+    //        Constants::noise_block_size at a time into a buffer
+    //        the calls then only read from.
+    //        the sequence depends on the seed and the voice only,
+    //        so two renders of the same session are the same.
+    //-----------------------------------------------------------
+    class SynthNoise
+    {
+    public:
+        typedef Real result_type;
+        static ModParamList const params;
+        
+        explicit SynthNoise(NoiseType _type);
+        SynthNoise(NoiseType _type, Real _rate);
+        
+        inline Real operator()()
+        {
+            if(m_index == Constants::noise_block_size) Refill();
+            return m_block[m_index++];
+        }
+        
+        void SetSampleRate(std::size_t _sr);
+        
+        void SetVoice(std::size_t _voice);
+        
+        // changes per second of the sample and hold
+        void SetRate(Real _rate);
+        
+        inline Real GetRate() const
+        { return m_rate; }
+        
+        void SetSeed(Real _seed);
+        
+        inline Real GetSeed() const
+        { return Real(m_seed); }
+        
+    private:
+        void Reseed();
+        void Refill();
+        
+        NoiseType m_type;
+        Real m_rate;
+        std::size_t m_sample_rate;
+        std::uint32_t m_seed;
+        std::size_t m_voice;
+        std::uint32_t m_key;
+        std::uint32_t m_counter;
+        std::array<Real, Constants::noise_block_size> m_block;
+        std::size_t m_index;
+        // pink filter
+        std::array<Real, 3> m_pink;
+        // sample and hold
+        Real m_hold;
+        Real m_hold_phase;
+        Real m_hold_step;
+        
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
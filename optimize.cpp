@@ -0,0 +1,219 @@
+//-----------------------------------------------------------
+//    optimize.cpp
+//-----------------------------------------------------------
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "optimize.h"
+#include "mixer.h"
+#include "vca.h"
+#include "vcf.h"
+#include "oversample.h"
+#include "lfo.h"
+
+namespace TSynth{
+
+    namespace{
+        //-----------------------------------------------------------
+        //    the patch as nested nodes while it is rewritten, each
+        //    with the preorder index it had when parsed
+        //-----------------------------------------------------------
+        struct Node
+        {
+            SynthModBasePtr mod;
+            std::size_t index;
+            std::vector<Node> inputs;
+        };
+
+        struct Input
+        {
+            Node node;
+            Real gain;
+        };
+
+        class Optimizer
+        {
+        public:
+            Optimizer(ModTree const& _tree, PatchLinks const& _links)
+                : m_tree(_tree), m_links(_links), m_children(_tree.size())
+            {
+                for(auto it = _tree.preorder_begin(), end = _tree.preorder_end(); it != end; ++it){
+                    auto const parent = it.get_parent();
+                    if(parent != end) m_children[parent.node()].push_back(it.node());
+                }
+            }
+
+            Node Build(std::size_t _index) const
+            {
+                Node node = {m_tree[_index], _index, std::vector<Node>()};
+                for(std::size_t i = 0; i < m_children[_index].size(); ++i)
+                    node.inputs.push_back(Build(m_children[_index][i]));
+                return node;
+            }
+
+            void Optimize(Node& _node) const
+            {
+                for(std::size_t i = 0; i < _node.inputs.size(); ++i)
+                    Optimize(_node.inputs[i]);
+                if(!IsPlainMixer(_node)) return;
+
+                std::vector<Input> inputs;
+                std::size_t merged = 0;
+                for(std::size_t i = 0; i < _node.inputs.size(); ++i){
+                    Node const& input = _node.inputs[i];
+                    merged += (IsPlainMixer(input) && !IsLinked(input)) ? input.inputs.size() : 1;
+                }
+                bool const merge = (merged <= Mixer::max_inputs);
+
+                for(std::size_t i = 0; i < _node.inputs.size(); ++i){
+                    Node& input = _node.inputs[i];
+                    Real const gain = _node.mod->GetParam(i);
+                    if((gain == 0.0 || IsSilent(input)) && !MustKeep(input)) continue;
+                    if(merge && IsPlainMixer(input) && !IsLinked(input)){
+                        for(std::size_t j = 0; j < input.inputs.size(); ++j)
+                            inputs.push_back(Input{input.inputs[j], gain * input.mod->GetParam(j)});
+                    }else{
+                        inputs.push_back(Input{input, gain});
+                    }
+                }
+                // a Mixer that never sounds is left for its parent
+                if(inputs.empty()) return;
+
+                // the nodes run ahead are added to the graph in the order
+                // they are met, so a Mixer with any of them keeps its order
+                bool keep_order = false;
+                for(std::size_t i = 0; i < inputs.size(); ++i){
+                    if(MustKeep(inputs[i].node)) keep_order = true;
+                }
+                if(!keep_order){
+                    std::stable_sort(inputs.begin(), inputs.end(),
+                        [](Input const& _a, Input const& _b){ return _a.node.mod->Name() < _b.node.mod->Name(); });
+                }
+
+                _node.inputs.clear();
+                for(std::size_t i = 0; i < Mixer::max_inputs; ++i){
+                    if(i < inputs.size()){
+                        _node.inputs.push_back(inputs[i].node);
+                        _node.mod->SetParam(i, inputs[i].gain);
+                    }else{
+                        _node.mod->SetParam(i, 1.0);
+                    }
+                }
+
+                if(_node.inputs.size() == 1 && _node.mod->GetParam(0) == 1.0 && !IsLinked(_node)){
+                    Node input = _node.inputs[0];
+                    _node = input;
+                }
+            }
+
+        private:
+            ModTree const& m_tree;
+            PatchLinks const& m_links;
+            std::vector<std::vector<std::size_t>> m_children;
+
+            // named, read through a $name, a $name itself or a port
+            bool IsLinked(Node const& _node) const
+            {
+                return m_links.ahead[_node.index] || m_links.refs[_node.index] != PatchLinks::npos;
+            }
+
+            bool IsPlainMixer(Node const& _node) const
+            {
+                if(!_node.mod->As<Mixer>() || _node.inputs.empty() || _node.inputs.size() > Mixer::max_inputs)
+                    return false;
+                for(std::size_t i = 0; i < _node.inputs.size(); ++i){
+                    if(m_links.IsPort(_node.inputs[i].index)) return false;
+                }
+                return true;
+            }
+
+            // lfos are found by the ParamTable in the tree, linked
+            // nodes by their index
+            bool MustKeep(Node const& _node) const
+            {
+                if(IsLinked(_node) || _node.mod->As<SynthLFO>()) return true;
+                for(std::size_t i = 0; i < _node.inputs.size(); ++i){
+                    if(MustKeep(_node.inputs[i])) return true;
+                }
+                return false;
+            }
+
+            // true if the output is 0 whatever is played. the filters
+            // and the envelopes only scale what comes in
+            bool IsSilent(Node const& _node) const
+            {
+                if(IsLinked(_node)) return false;
+                if(_node.mod->As<SynthLFO>()) return true;
+                if(SynthVCA const* vca = _node.mod->As<SynthVCA>()){
+                    SynthEG const& eg = vca->GetEG();
+                    if(vca->GetLevel() == 0.0) return true;
+                    if(eg.GetAttack() == 0.0 && eg.GetDecay() == 0.0
+                        && eg.GetSustain() == 0.0 && eg.GetRelease() == 0.0) return true;
+                    return SignalSilent(_node);
+                }
+                if(_node.mod->As<SynthVCF>() || _node.mod->As<Oversample>())
+                    return SignalSilent(_node);
+                if(IsPlainMixer(_node)){
+                    for(std::size_t i = 0; i < _node.inputs.size(); ++i){
+                        if(_node.mod->GetParam(i) != 0.0 && !IsSilent(_node.inputs[i])) return false;
+                    }
+                    return true;
+                }
+                return false;
+            }
+
+            bool SignalSilent(Node const& _node) const
+            {
+                bool any = false;
+                for(std::size_t i = 0; i < _node.inputs.size(); ++i){
+                    if(m_links.IsPort(_node.inputs[i].index)) continue;
+                    if(!IsSilent(_node.inputs[i])) return false;
+                    any = true;
+                }
+                return any;
+            }
+        };
+
+        // appends _node under _parent in preorder, _map takes the
+        // new index of every old one
+        void Emit(Node const& _node, ModTree& _tree, ModTree::preorder_iterator _parent,
+            std::vector<std::size_t>& _map, std::vector<std::size_t>& _order)
+        {
+            ModTree::preorder_iterator it = (_tree.empty())
+                ? _tree.insert(_tree.preorder_begin(), _node.mod)
+                : _tree.append_child(_parent, _node.mod);
+            _map[_node.index] = _order.size();
+            _order.push_back(_node.index);
+            for(std::size_t i = 0; i < _node.inputs.size(); ++i)
+                Emit(_node.inputs[i], _tree, it, _map, _order);
+        }
+    }
+
+    OptimizeResult OptimizePatch(ModTree& _tree, PatchLinks& _links)
+    {
+        OptimizeResult result = {_tree.size(), _tree.size()};
+        if(_tree.empty()) return result;
+
+        Optimizer const optimizer(_tree, _links);
+        Node root = optimizer.Build(0);
+        optimizer.Optimize(root);
+
+        ModTree tree;
+        std::vector<std::size_t> map(_tree.size(), PatchLinks::npos);
+        std::vector<std::size_t> order;
+        Emit(root, tree, tree.preorder_begin(), map, order);
+
+        PatchLinks links;
+        for(std::size_t i = 0; i < order.size(); ++i){
+            std::size_t const ref = _links.refs[order[i]];
+            links.refs.push_back((ref == PatchLinks::npos) ? ref : map[ref]);
+            links.ports.push_back(_links.ports[order[i]]);
+            links.ahead.push_back(_links.ahead[order[i]]);
+        }
+
+        _tree = tree;
+        _links = links;
+        result.after = _tree.size();
+        return result;
+    }
+}//---- namespace
@@ -0,0 +1,44 @@
+//-----------------------------------------------------------
+//    patch optimizer
+//-----------------------------------------------------------
+#ifndef SYNTH_OPTIMIZE_H
+#define SYNTH_OPTIMIZE_H
+
+#include <cstddef>
+#include "synth_mod_base.h"
+#include "patch_graph.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    struct OptimizeResult
+    //        nodes of a patch as written and as played
+    //-----------------------------------------------------------
+    struct OptimizeResult
+    {
+        std::size_t before;
+        std::size_t after;
+    };
+
+    //-----------------------------------------------------------
+    //    OptimizePatch
+    //        rewrites a parsed patch into a cheaper one that sounds
+    //        the same, before it is bound:
+    //        an input of a Mixer that is a Mixer itself is merged
+    //        into it, the gains multiplied, which also fuses chains
+    //        of one input Mixers into one gain;
+    //        a Mixer left with one input at gain 1 is replaced by
+    //        the input;
+    //        inputs of a Mixer that can never sound are removed, i.e.
+    //        ones at gain 0 and ones under a SynthVCA at level 0 or
+    //        with an envelope of all zeros;
+    //        the inputs of a Mixer are put in order of their mod, so
+    //        the same code runs back to back, unless one of them is
+    //        or holds a linked node.
+    //        SynthLFOs, named nodes, $names and ports are kept as
+    //        they are, as are Mixers with ports.
+    //-----------------------------------------------------------
+    OptimizeResult OptimizePatch(ModTree& _tree, PatchLinks& _links);
+}//---- namespace
+
+#endif
@@ -0,0 +1,45 @@
+//-----------------------------------------------------------
+//    oversample.cpp
+//-----------------------------------------------------------
+#include <cmath>
+#include "oversample.h"
+
+namespace TSynth{
+    TSYNTH_DECLARE_PULL_MOD(Oversample, (StoD()))
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void MakeHalfBand(Real* _coefficients, std::size_t _k)
+    {
+        std::size_t const taps = 2 * _k;
+        // offsets from the center are -(2k - 1) ... 2k - 1, odd only
+        Real const width = Real(4 * _k);
+        Real sum = 0.0;
+        for(std::size_t j = 0; j < taps; ++j){
+            Real const m = Real(2 * j) - Real(taps - 1);
+            Real const sinc = std::sin(M_PI * m * 0.5) / (M_PI * m);
+            Real const window = 0.42 + 0.5 * std::cos(2.0 * M_PI * m / width)
+                + 0.08 * std::cos(4.0 * M_PI * m / width);
+            _coefficients[j] = sinc * window;
+            sum += _coefficients[j];
+        }
+        // unity gain at dc with the 0.5 of the center tap
+        for(std::size_t j = 0; j < taps; ++j)
+            _coefficients[j] *= 0.5 / sum;
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    Oversample::Oversample()
+        : m_factor(2), m_first(), m_last()
+    {}
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    Oversample::Oversample(Real _factor)
+        : m_factor((_factor < 3.0) ? 2 : 4), m_first(), m_last()
+    {}
+}//---- namespace
@@ -0,0 +1,117 @@
+//-----------------------------------------------------------
+//    Oversample
+//-----------------------------------------------------------
+#ifndef SYNTH_OVERSAMPLE_H
+#define SYNTH_OVERSAMPLE_H
+
+#include <array>
+#include <functional>
+#include "type.h"
+#include "synth_mod.h"
+
+namespace TSynth{
+    
+    // the 2 _k odd taps of a blackman windowed half-band FIR, in the
+    // order of the samples they weight from the newest
+    void MakeHalfBand(Real* _coefficients, std::size_t _k);
+    
+    //-----------------------------------------------------------
+    //    class HalfBandDecimator
+    //        halves the rate with a 4K - 1 tap half-band FIR in
+    //        polyphase form: every other coefficient is 0 but the
+    //        center one, so the later sample of each pair goes
+    //        through a 2K tap FIR and the earlier one is only
+    //        delayed. the history is kept twice so the taps are
+    //        always contiguous, and the dot product runs in four
+    //        independent lanes the compiler can vectorize.
+    //-----------------------------------------------------------
+    template<std::size_t K>
+    class HalfBandDecimator
+    {
+    public:
+        static std::size_t const taps = 2 * K;
+        static std::size_t const lanes = 4;
+        static_assert(taps % lanes == 0, "TSynth::HalfBandDecimator");
+        
+        HalfBandDecimator()
+            : m_coefficients(), m_history(), m_position(0), m_delay(), m_delay_position(0)
+        {
+            MakeHalfBand(&m_coefficients[0], K);
+            m_history.fill(0.0);
+            m_delay.fill(0.0);
+        }
+        
+        // _a, _b: two samples at the high rate, _a first
+        inline Real operator()(Real _a, Real _b)
+        {
+            m_position = (m_position == 0) ? taps - 1 : m_position - 1;
+            m_history[m_position] = _b;
+            m_history[m_position + taps] = _b;
+            
+            Real const* x = &m_history[m_position];
+            std::array<Real, lanes> acc = {{0.0}};
+            for(std::size_t j = 0; j < taps; j += lanes){
+                for(std::size_t l = 0; l < lanes; ++l)
+                    acc[l] += x[j + l] * m_coefficients[j + l];
+            }
+            
+            m_delay[m_delay_position] = _a;
+            m_delay_position = (m_delay_position + 1 == K) ? 0 : m_delay_position + 1;
+            return 0.5 * m_delay[m_delay_position] + (acc[0] + acc[1]) + (acc[2] + acc[3]);
+        }
+        
+    private:
+        std::array<Real, taps> m_coefficients;
+        std::array<Real, taps * 2> m_history;
+        std::size_t m_position;
+        // the earlier samples, K - 1 pairs late
+        std::array<Real, K> m_delay;
+        std::size_t m_delay_position;
+    };
+    
+    //-----------------------------------------------------------
+    //    class Oversample
+    //        runs its input at 2 or 4 times the rate and brings it
+    //        back down through half-band decimators, 31 taps for the
+    //        last halving and 15 for the first one of 4x. the mods
+    //        under it are set to the higher rate when the patch is
+    //        bound (see MonoSynth::BindModsInTree). a factor under 3
+    //        is 2, anything else 4.
+    //-----------------------------------------------------------
+    class Oversample
+    {
+    public:
+        typedef Real result_type;
+        
+        Oversample();
+        explicit Oversample(Real _factor);
+        
+        inline Real operator()(std::function<Real(void)> const& _in)
+        {
+            if(m_factor == 2){
+                Real const a = _in();
+                Real const b = _in();
+                return m_last(a, b);
+            }
+            Real const a0 = _in();
+            Real const a1 = _in();
+            Real const b0 = _in();
+            Real const b1 = _in();
+            Real const a = m_first(a0, a1);
+            Real const b = m_first(b0, b1);
+            return m_last(a, b);
+        }
+        
+        inline std::size_t Factor() const
+        { return m_factor; }
+        
+    private:
+        std::size_t m_factor;
+        HalfBandDecimator<4> m_first;
+        HalfBandDecimator<8> m_last;
+        
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
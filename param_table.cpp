@@ -0,0 +1,262 @@
+//-----------------------------------------------------------
+//    param_table.cpp
+//-----------------------------------------------------------
+#include <map>
+#include <sstream>
+#include <algorithm>
+#include <assert.h>
+#include "param_table.h"
+#include "constants.h"
+
+namespace TSynth{
+
+    ParamTable::ParamTable(MonoSynth const& _prototype)
+        : m_slots(), m_size(0),
+        m_route_buffers(new std::array<Route, route_buffers>[max_routes]),
+        m_posted(), m_unmapped(), m_route_states(), m_lfos(), m_modulating(0), m_block(1),
+        m_generation(0), m_seen_generation(0), m_ramping(0)
+    {
+        for(std::size_t r = 0; r < max_routes; ++r){
+            for(std::size_t b = 0; b < route_buffers; ++b)
+                m_route_buffers[r][b].in_use.store(false, std::memory_order_relaxed);
+            m_posted[r].store(0, std::memory_order_relaxed);
+            m_route_states[r].route = 0;
+        }
+
+        for(std::size_t i = 0; i < _prototype.ModCount(); ++i)
+            m_size += _prototype.ModAt(i).Params().size;
+        m_slots.reset(new Slot[m_size]);
+
+        std::map<std::string, std::size_t> ordinals;
+        std::size_t k = 0;
+        for(std::size_t i = 0; i < _prototype.ModCount(); ++i){
+            SynthModBase const& mod = _prototype.ModAt(i);
+            ModParamList const params = mod.Params();
+            std::size_t const ordinal = ordinals[mod.Name()]++;
+            for(std::size_t j = 0; j < params.size; ++j, ++k){
+                std::ostringstream os;
+                os << mod.Name() << ordinal << "." << params.params[j].name;
+                Slot& slot = m_slots[k];
+                slot.path = os.str();
+                slot.node = i;
+                slot.param = j;
+                slot.smooth = params.params[j].smooth;
+                slot.value = slot.target = mod.GetParam(j);
+                slot.request.store(slot.value, std::memory_order_relaxed);
+                slot.step = 0.0;
+                slot.remaining = 0;
+            }
+            SynthLFO const* const lfo = mod.As<SynthLFO>();
+            if(lfo && m_lfos.size() < max_lfos)
+                m_lfos.push_back(Lfo{i, lfo->IsGlobal(), {{}}});
+        }
+    }
+
+    std::size_t ParamTable::Find(std::string const& _path) const
+    {
+        for(std::size_t k = 0; k < m_size; ++k){
+            if(m_slots[k].path == _path) return k;
+        }
+        return npos;
+    }
+    
+    bool ParamTable::Request(std::string const& _path, Real _value)
+    {
+        std::size_t const k = Find(_path);
+        if(k == npos) return false;
+        m_slots[k].request.store(_value, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+    
+    bool ParamTable::Map(std::size_t _index, ModRoute const& _route)
+    {
+        assert(_index < max_routes);
+        std::size_t const k = Find(_route.path);
+        if(k == npos) return false;
+        Route* route = 0;
+        for(std::size_t b = 0; b < route_buffers && !route; ++b){
+            if(!m_route_buffers[_index][b].in_use.load(std::memory_order_acquire))
+                route = &m_route_buffers[_index][b];
+        }
+        assert(route);
+        route->route = _route;
+        route->slot = k;
+        route->in_use.store(true, std::memory_order_relaxed);
+        Post(_index, route);
+        return true;
+    }
+    
+    void ParamTable::Unmap(std::size_t _index)
+    {
+        assert(_index < max_routes);
+        Post(_index, &m_unmapped);
+    }
+
+    // a route posted before and never taken is freed here
+    void ParamTable::Post(std::size_t _index, Route* _route)
+    {
+        Route* const old = m_posted[_index].exchange(_route, std::memory_order_acq_rel);
+        if(old && old != &m_unmapped) old->in_use.store(false, std::memory_order_relaxed);
+    }
+
+    std::vector<std::pair<std::string, Real>> ParamTable::Requested() const
+    {
+        std::vector<std::pair<std::string, Real>> tmp;
+        tmp.reserve(m_size);
+        for(std::size_t k = 0; k < m_size; ++k)
+            tmp.push_back(std::make_pair(m_slots[k].path,
+                m_slots[k].request.load(std::memory_order_relaxed)));
+        return tmp;
+    }
+
+    // a new request for a ramping slot starts a fresh ramp from where
+    // the old one got to
+    void ParamTable::Update(MonoSynth* _voices, std::size_t _n)
+    {
+        std::uint64_t const generation = m_generation.load(std::memory_order_acquire);
+        if(generation == m_seen_generation) return;
+        m_seen_generation = generation;
+
+        for(std::size_t k = 0; k < m_size; ++k){
+            Slot& slot = m_slots[k];
+            Real const request = slot.request.load(std::memory_order_relaxed);
+            if(request == slot.target) continue;
+            slot.target = request;
+            if(slot.smooth){
+                if(slot.remaining == 0) ++m_ramping;
+                slot.remaining = Constants::param_ramp_samples;
+                slot.step = (slot.target - slot.value) / Real(slot.remaining);
+            }else{
+                slot.value = slot.target;
+                for(std::size_t i = 0; i < _n; ++i)
+                    _voices[i].SetParam(slot.node, slot.param, slot.value);
+            }
+        }
+    }
+
+    // a route whose value did not move over the block is set on every
+    // voice at once, only moving ones need ApplyRamps
+    void ParamTable::Modulate(ModSources const& _sources, MonoSynth* _voices,
+        std::uint8_t const* _notes, std::size_t _n, std::size_t _block)
+    {
+        assert(_n <= max_voices);
+        m_block = _block;
+        m_modulating = 0;
+        
+        // an idle voice only keeps its phase going
+        std::size_t points = _block / Constants::param_ramp_chunk + 1;
+        if(points > Constants::lfo_max_points) points = Constants::lfo_max_points;
+        for(std::size_t k = 0; k < m_lfos.size(); ++k){
+            Lfo& lfo = m_lfos[k];
+            if(lfo.global){
+                SynthLFO* const shared = _voices[0].ModAt(lfo.node).As<SynthLFO>();
+                shared->Advance(_block, points);
+                lfo.voices.fill(shared);
+                // the copies the other voices run as a port or a $name
+                // take the same values
+                for(std::size_t i = 0; i < _n; ++i){
+                    if(i != 0 && !_voices[i].IsActive()) continue;
+                    if(i != 0) _voices[i].ModAt(lfo.node).As<SynthLFO>()->CopyPoints(*shared);
+                    if(MonoSynth* const right = _voices[i].Right())
+                        right->ModAt(lfo.node).As<SynthLFO>()->CopyPoints(*shared);
+                }
+                continue;
+            }
+            for(std::size_t i = 0; i < _n; ++i){
+                std::size_t const own_points = (_voices[i].IsActive()) ? points : 2;
+                SynthLFO* const own = _voices[i].ModAt(lfo.node).As<SynthLFO>();
+                own->Advance(_block, own_points);
+                lfo.voices[i] = own;
+                // the right channel plays the same lfo
+                if(MonoSynth* const right = _voices[i].Right())
+                    right->ModAt(lfo.node).As<SynthLFO>()->Advance(_block, own_points);
+            }
+        }
+        
+        for(std::size_t r = 0; r < max_routes; ++r){
+            RouteState& state = m_route_states[r];
+            Route* const posted = m_posted[r].exchange(0, std::memory_order_acquire);
+            Route* const route = (!posted) ? state.route : (posted == &m_unmapped) ? 0 : posted;
+            
+            // a parameter no longer driven goes back to its own value
+            if(state.route && (!route || route->slot != state.route->slot)){
+                Slot const& slot = m_slots[state.route->slot];
+                for(std::size_t i = 0; i < _n; ++i)
+                    _voices[i].SetParam(slot.node, slot.param, slot.value);
+            }
+            bool const fresh = (route != state.route);
+            if(fresh && state.route) state.route->in_use.store(false, std::memory_order_release);
+            state.route = route;
+            if(!route) continue;
+            
+            bool const lfo = (route->route.source.kind == ModSourceKind::LFO);
+            bool moving = lfo;
+            for(std::size_t i = 0; i < _n; ++i){
+                Real const v = route->route.Scale((lfo)
+                    ? LfoValue(route->route.source.number, i, _block)
+                    : _sources.Value(route->route.source, _notes[i]));
+                state.from[i] = (fresh) ? v : state.to[i];
+                state.to[i] = v;
+                moving = moving || (state.from[i] != v);
+            }
+            if(moving){
+                ++m_modulating;
+                continue;
+            }
+            Slot const& slot = m_slots[route->slot];
+            for(std::size_t i = 0; i < _n; ++i)
+                _voices[i].SetParam(slot.node, slot.param, state.to[i]);
+        }
+    }
+    
+    void ParamTable::ApplyRamps(MonoSynth& _voice, std::size_t _index, std::size_t _offset) const
+    {
+        for(std::size_t k = 0; k < m_size; ++k){
+            Slot const& slot = m_slots[k];
+            if(slot.remaining == 0) continue;
+            Real const v = (_offset < slot.remaining)
+                ? slot.value + slot.step * Real(_offset)
+                : slot.target;
+            _voice.SetParam(slot.node, slot.param, v);
+        }
+        // routes after the ramps, a driven parameter follows its source
+        for(std::size_t r = 0; r < max_routes; ++r){
+            RouteState const& state = m_route_states[r];
+            if(!state.route) continue;
+            Slot const& slot = m_slots[state.route->slot];
+            ModRoute const& route = state.route->route;
+            Real const v = (route.source.kind == ModSourceKind::LFO)
+                ? route.Scale(LfoValue(route.source.number, _index, _offset))
+                : state.from[_index] + (state.to[_index] - state.from[_index]) * Real(_offset) / Real(m_block);
+            _voice.SetParam(slot.node, slot.param, v);
+        }
+    }
+
+    // a route from an lfo the patch does not have stays in the middle
+    Real ParamTable::LfoValue(std::size_t _lfo, std::size_t _index, std::size_t _offset) const
+    {
+        if(_lfo >= m_lfos.size()) return 0.5;
+        return 0.5 + 0.5 * m_lfos[_lfo].voices[_index]->At(_offset, m_block);
+    }
+
+    // the voices that did not play this block get the final value
+    // when a ramp ends
+    void ParamTable::AdvanceRamps(MonoSynth* _voices, std::size_t _n, std::size_t _samples)
+    {
+        for(std::size_t k = 0; k < m_size; ++k){
+            Slot& slot = m_slots[k];
+            if(slot.remaining == 0) continue;
+            std::size_t const advance = std::min(_samples, slot.remaining);
+            slot.remaining -= advance;
+            if(slot.remaining != 0){
+                slot.value += slot.step * Real(advance);
+                continue;
+            }
+            slot.value = slot.target;
+            --m_ramping;
+            for(std::size_t i = 0; i < _n; ++i)
+                _voices[i].SetParam(slot.node, slot.param, slot.value);
+        }
+    }
+}//---- namespace
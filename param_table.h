@@ -0,0 +1,149 @@
+//-----------------------------------------------------------
+//    ParamTable
+//-----------------------------------------------------------
+#ifndef SYNTH_PARAM_TABLE_H
+#define SYNTH_PARAM_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "type.h"
+#include "mono_synth.h"
+#include "mod_matrix.h"
+#include "lfo.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    class ParamTable
+    //        live parameters of one set of voices, addressed as
+    //        <mod name><ordinal>.<parameter>, e.g. SynthVCF0.cutoff.
+    //        the ordinal counts the mods of that name in preorder.
+    //        the control thread stores requested values into
+    //        atomic slots, the audio thread takes them at the next
+    //        block, sets them on every voice and ramps the smooth
+    //        ones over Constants::param_ramp_samples.
+    //        up to max_routes ModRoutes drive parameters from midi
+    //        sources; they are read once per block and interpolated
+    //        over it, per voice for polypressure.
+    //        the SynthLFOs of the patch are moved on here once per
+    //        block, in every voice or only in voice 0 for a global
+    //        one, and routes from them step through the values the
+    //        lfo took for the block.
+    //-----------------------------------------------------------
+    class ParamTable
+    {
+    public:
+        static std::size_t const max_routes = 16;
+        static std::size_t const max_voices = 32;
+        static std::size_t const max_lfos = 8;
+        static std::size_t const npos = std::size_t(-1);
+        
+        explicit ParamTable(MonoSynth const& _prototype);
+
+        // control thread. false if there is no such parameter
+        bool Request(std::string const& _path, Real _value);
+        // index of the slot for _path, npos if there is none
+        std::size_t Find(std::string const& _path) const;
+        // every parameter with the value last asked for
+        std::vector<std::pair<std::string, Real>> Requested() const;
+        // sets route _index, false if the path is not in this patch
+        bool Map(std::size_t _index, ModRoute const& _route);
+        void Unmap(std::size_t _index);
+
+        // audio thread, at the start of a block
+        void Update(MonoSynth* _voices, std::size_t _n);
+
+        // after the notes of the block are known. _notes[i] is the
+        // note of voice i
+        void Modulate(ModSources const& _sources, MonoSynth* _voices,
+            std::uint8_t const* _notes, std::size_t _n, std::size_t _block);
+
+        inline bool Ramping() const
+        { return m_ramping != 0 || m_modulating != 0; }
+
+        // sets the ramped values of voice _index _offset samples into
+        // the block
+        void ApplyRamps(MonoSynth& _voice, std::size_t _index, std::size_t _offset) const;
+
+        // moves the ramps on by one block
+        void AdvanceRamps(MonoSynth* _voices, std::size_t _n, std::size_t _samples);
+
+    private:
+        // from 0 to 1, for lfo<_lfo> in voice _index
+        Real LfoValue(std::size_t _lfo, std::size_t _index, std::size_t _offset) const;
+
+        struct Slot
+        {
+            Slot() : request(0.0) {}
+
+            std::string path;
+            std::size_t node;
+            std::size_t param;
+            bool smooth;
+            std::atomic<Real> request;
+            // audio thread
+            Real target;
+            Real value;
+            Real step;
+            std::size_t remaining;
+        };
+
+        struct Lfo
+        {
+            std::size_t node;
+            bool global;
+            // audio thread, the lfo each voice reads this block
+            std::array<SynthLFO const*, max_voices> voices;
+        };
+
+        // in_use from when the control thread posts it until the
+        // audio thread drops it or it is replaced before being taken
+        struct Route
+        {
+            ModRoute route;
+            std::size_t slot;
+            std::atomic<bool> in_use;
+        };
+
+        // audio thread
+        struct RouteState
+        {
+            Route* route;
+            std::array<Real, max_voices> from;
+            std::array<Real, max_voices> to;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::size_t m_size;
+        // a route is never changed while the audio thread may read
+        // it. a new one is written to a free buffer of its index and
+        // posted; the audio thread takes it at its next block and
+        // frees the one it held. one held, one being freed and one
+        // posted are in use at most, so the fourth is always free
+        static std::size_t const route_buffers = 4;
+        std::unique_ptr<std::array<Route, route_buffers>[]> m_route_buffers;
+        std::array<std::atomic<Route*>, max_routes> m_posted;
+        // posted by Unmap
+        Route m_unmapped;
+        std::array<RouteState, max_routes> m_route_states;
+        std::vector<Lfo> m_lfos;
+        std::size_t m_modulating;
+        std::size_t m_block;
+        std::atomic<std::uint64_t> m_generation;
+        std::uint64_t m_seen_generation;
+        std::size_t m_ramping;
+
+        void Post(std::size_t _index, Route* _route);
+
+        ParamTable(ParamTable const&);
+        ParamTable& operator=(ParamTable const&);
+    };
+}//---- namespace
+
+#endif
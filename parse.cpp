@@ -1,24 +1,136 @@
 #include <vector>
+#include <map>
 #include <functional>
 #include <numeric>
+#include <stdexcept>
 #include <boost/lexical_cast.hpp>
 #include "parse.h"
 #include "mod_factory.h"
 
 namespace TSynth{
-    bool Parse(std::string const& _strexpr, creek::tree<SynthModBasePtr>& _tree)
+    namespace{
+        //-----------------------------------------------------------
+        //    a node token is [<param>[*<depth>]:][<name>=]<body>,
+        //    the body a mod or a $name. ':' and '=' only count
+        //    before the parameters of the mod.
+        //-----------------------------------------------------------
+        struct NodeToken
+        {
+            std::string port;
+            Real depth;
+            std::string name;
+            std::string body;
+        };
+        
+        bool SplitNodeToken(std::string const& _token, NodeToken& _out)
+        {
+            std::string::size_type const args = _token.find('[');
+            std::string head = _token.substr(0, args);
+            std::string const tail = (args == std::string::npos) ? std::string() : _token.substr(args);
+            
+            _out.port.clear();
+            _out.depth = 1.0;
+            std::string::size_type const colon = head.find(':');
+            if(colon != std::string::npos){
+                std::string port = head.substr(0, colon);
+                head.erase(0, colon + 1);
+                std::string::size_type const star = port.find('*');
+                if(star != std::string::npos){
+                    try{
+                        _out.depth = boost::lexical_cast<Real>(port.substr(star + 1));
+                    }catch(boost::bad_lexical_cast const&){
+                        return false;
+                    }
+                    port.erase(star);
+                }
+                if(port.empty()) return false;
+                _out.port = port;
+            }
+            
+            _out.name.clear();
+            std::string::size_type const equal = head.find('=');
+            if(equal != std::string::npos){
+                _out.name = head.substr(0, equal);
+                head.erase(0, equal + 1);
+                if(_out.name.empty()) return false;
+            }
+            
+            _out.body = head + tail;
+            return !_out.body.empty() && (_out.body[0] != '$' || (_out.body.size() > 1 && tail.empty()));
+        }
+        
+        //-----------------------------------------------------------
+        //    the mod of a node token, its links recorded as the
+        //    node _node with its parent at _parent
+        //-----------------------------------------------------------
+        SynthModBasePtr MakeNode(NodeToken const& _token, std::size_t _node,
+            ModTree::preorder_iterator _parent, ModTree::preorder_iterator _end,
+            std::map<std::string, std::size_t>& _names, PatchLinks& _links)
+        {
+            SynthModBasePtr mod;
+            std::size_t ref = PatchLinks::npos;
+            if(_token.body[0] == '$'){
+                std::string const name = _token.body.substr(1);
+                auto found = _names.find(name);
+                if(found == _names.end())
+                    throw std::runtime_error("$" + name + " is not defined before it is used");
+                ref = found->second;
+                for(auto it = _parent; it != _end; it = it.get_parent()){
+                    if(it.node() == ref)
+                        throw std::runtime_error("$" + name + " is used inside itself");
+                }
+                mod = MakeNodeRef();
+            }else{
+                mod = MakeSynthModFromString(_token.body);
+            }
+            
+            if(!_token.name.empty()){
+                if(!_names.insert(std::make_pair(_token.name, _node)).second)
+                    throw std::runtime_error(_token.name + " is defined twice");
+            }
+            
+            PatchLinks::Port port = {PatchLinks::npos, _token.depth};
+            if(!_token.port.empty()){
+                if(_parent == _end)
+                    throw std::runtime_error("the root cannot be a port");
+                ModParamList const params = (**_parent).Params();
+                for(std::size_t i = 0; i < params.size; ++i){
+                    if(_token.port == params.params[i].name) port.param = i;
+                }
+                if(port.param == PatchLinks::npos)
+                    throw std::runtime_error((**_parent).Name() + " has no parameter " + _token.port);
+            }
+            
+            _links.refs.push_back(ref);
+            _links.ports.push_back(port);
+            return mod;
+        }
+    }
+    
+    bool Parse(std::string const& _strexpr, ModTree& _tree)
+    {
+        PatchLinks links;
+        if(!Parse(_strexpr, _tree, links)) return false;
+        return links.Empty();
+    }
+    
+    bool Parse(std::string const& _strexpr, ModTree& _tree, PatchLinks& _links)
     {
         if(_strexpr == "") return false;
         
-        typedef creek::tree<SynthModBasePtr>::preorder_iterator preorder_iterator;
-        creek::tree<SynthModBasePtr> treetmp;
+        typedef ModTree::preorder_iterator preorder_iterator;
+        ModTree treetmp;
         preorder_iterator curr = treetmp.preorder_begin();
         
         std::string::const_iterator it_str = _strexpr.begin(), it_end = _strexpr.end();
         int rbracket_count = 0, lbracket_count = 0;
         
+        PatchLinks links;
+        std::map<std::string, std::size_t> names;
+        std::size_t count = 0;
+        NodeToken node;
         
-        creek::tree<std::string> treestr;
+        creek::flat_tree<std::string> treestr;
         auto itstr = treestr.preorder_begin();
         while(1){
             std::string token = GetToken(it_str, it_end);
@@ -30,12 +142,15 @@ namespace TSynth{
                 token = GetToken(it_str, it_end);
                 if(token == "(" || token == ")" || token == "")
                     return false;
+                // a $name has no inputs of its own
+                if(!SplitNodeToken(token, node) || node.body[0] == '$')
+                    return false;
                 
                 if(treetmp.empty()){
-                    curr = treetmp.insert(curr, MakeSynthModFromString(token));
+                    curr = treetmp.insert(curr, MakeNode(node, count++, treetmp.preorder_end(), treetmp.preorder_end(), names, links));
                     itstr = treestr.insert(itstr, token);
                 }else{
-                    curr = treetmp.append_child(curr, MakeSynthModFromString(token));
+                    curr = treetmp.append_child(curr, MakeNode(node, count++, curr, treetmp.preorder_end(), names, links));
                     itstr = treestr.append_child(itstr, token);
                 }
             }else if(token == ")"){
@@ -45,7 +160,8 @@ namespace TSynth{
                 itstr = itstr.get_parent();
             }else{
                 if(treetmp.empty()) return false;
-                treetmp.append_child(curr, MakeSynthModFromString(token));
+                if(!SplitNodeToken(token, node)) return false;
+                treetmp.append_child(curr, MakeNode(node, count++, curr, treetmp.preorder_end(), names, links));
                 treestr.append_child(itstr, token);
             }
             
@@ -53,11 +169,18 @@ namespace TSynth{
         
         if(rbracket_count != lbracket_count) return false;
         
+        links.ahead.assign(count, false);
+        for(std::size_t i = 0; i < count; ++i){
+            if(links.refs[i] != PatchLinks::npos) links.ahead[links.refs[i]] = true;
+            if(links.IsPort(i)) links.ahead[i] = true;
+        }
+        
         _tree = treetmp;
+        _links = links;
         return true;
     }
 
-    std::vector<std::string> SplitString(std::string const _str, std::string const& _delimiters = " []\t")
+    std::vector<std::string> SplitString(std::string const _str, std::string const& _delimiters)
     {
         std::string::const_iterator it1 = _str.begin(), end1 = _str.end();
         std::vector<std::string> splited;
@@ -6,12 +6,20 @@
 
 #include <string>
 #include <vector>
-#include "tree.h"
+#include "flat_tree.h"
 #include "synth_mod_base.h"
+#include "patch_graph.h"
 
 namespace TSynth{
 
-    bool Parse(std::string const& _strexpr, creek::tree<SynthModBasePtr>& _tree);
+    // false for a patch with $names or ports, which need the links
+    bool Parse(std::string const& _strexpr, ModTree& _tree);
+
+    // throws std::runtime_error for a $name, a name or a port that
+    // does not fit the patch
+    bool Parse(std::string const& _strexpr, ModTree& _tree, PatchLinks& _links);
+
+    std::vector<std::string> SplitString(std::string const _str, std::string const& _delimiters = " []\t");
 
     std::string GetToken(std::string::const_iterator& _it, std::string::const_iterator _end);
 
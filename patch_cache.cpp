@@ -0,0 +1,124 @@
+//-----------------------------------------------------------
+//    PatchCache
+//-----------------------------------------------------------
+#include <vector>
+#include "patch_cache.h"
+#include "parse.h"
+
+namespace TSynth{
+    
+    PatchCache::PatchCache(std::size_t _capacity)
+        :
+        m_capacity(_capacity),
+        m_entries(),
+        m_index(),
+        m_hits(0),
+        m_misses(0),
+        m_optimize(true),
+        m_mutex()
+    {
+    }
+    
+    PatchCache::PrototypePtr PatchCache::Get(std::string const& _str)
+    {
+        std::string const key = Normalize(_str);
+        bool optimize;
+        {
+            lock_type lk(m_mutex);
+            optimize = m_optimize;
+            auto found = m_index.find(key);
+            if(found != m_index.end()){
+                m_entries.splice(m_entries.begin(), m_entries, found->second);
+                ++m_hits;
+                return found->second->second;
+            }
+            ++m_misses;
+        }
+        
+        std::shared_ptr<MonoSynth> prototype = std::make_shared<MonoSynth>();
+        if(!prototype->ComposeMonoSynthFromString(_str, optimize)) return PrototypePtr();
+        
+        lock_type lk(m_mutex);
+        // made before the setting changed, not kept
+        if(m_capacity == 0 || optimize != m_optimize) return prototype;
+        auto found = m_index.find(key);
+        if(found != m_index.end()){
+            m_entries.erase(found->second);
+            m_index.erase(found);
+        }
+        m_entries.push_front(EntryType(key, prototype));
+        m_index[key] = m_entries.begin();
+        while(m_entries.size() > m_capacity){
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+        return prototype;
+    }
+    
+    void PatchCache::Clear()
+    {
+        lock_type lk(m_mutex);
+        m_index.clear();
+        m_entries.clear();
+    }
+    
+    void PatchCache::SetOptimize(bool _optimize)
+    {
+        lock_type lk(m_mutex);
+        if(_optimize == m_optimize) return;
+        m_optimize = _optimize;
+        m_index.clear();
+        m_entries.clear();
+    }
+    
+    bool PatchCache::Optimize() const
+    {
+        lock_type lk(m_mutex);
+        return m_optimize;
+    }
+    
+    std::size_t PatchCache::Size() const
+    {
+        lock_type lk(m_mutex);
+        return m_entries.size();
+    }
+    
+    std::size_t PatchCache::Hits() const
+    {
+        lock_type lk(m_mutex);
+        return m_hits;
+    }
+    
+    std::size_t PatchCache::Misses() const
+    {
+        lock_type lk(m_mutex);
+        return m_misses;
+    }
+    
+    // one space between tokens and between the name and parameters of a
+    // mod, the same split the mod factory sees.
+    std::string PatchCache::Normalize(std::string const& _str)
+    {
+        std::string key;
+        key.reserve(_str.size());
+        std::string::const_iterator it = _str.begin(), end = _str.end();
+        while(1){
+            std::string const token = GetToken(it, end);
+            if(token == "") break;
+            if(!key.empty()) key.push_back(' ');
+            if(token == "(" || token == ")"){
+                key += token;
+                continue;
+            }
+            std::vector<std::string> const words = SplitString(token);
+            key.push_back('[');
+            for(std::size_t i = 0; i < words.size(); ++i){
+                if(i != 0) key.push_back(' ');
+                key += words[i];
+            }
+            key.push_back(']');
+        }
+        return key;
+    }
+}//---- namespace
+
@@ -0,0 +1,66 @@
+//-----------------------------------------------------------
+//    PatchCache
+//-----------------------------------------------------------
+#ifndef SYNTH_PATCH_CACHE_H
+#define SYNTH_PATCH_CACHE_H
+
+#include <cstddef>
+#include <string>
+#include <list>
+#include <memory>
+#include <utility>
+#include <unordered_map>
+
+#include <boost/thread/recursive_mutex.hpp>
+
+#include "mono_synth.h"
+
+namespace TSynth{
+    
+    //-----------------------------------------------------------
+    //    class PatchCache
+    //        least recently used set of composed voices, keyed by
+    //        the normalized patch string. the prototypes are never
+    //        played, voices are cloned from them.
+    //-----------------------------------------------------------
+    class PatchCache
+    {
+    public:
+        typedef std::shared_ptr<MonoSynth const> PrototypePtr;
+        
+        explicit PatchCache(std::size_t _capacity);
+        
+        // returns a null pointer if the string does not parse
+        PrototypePtr Get(std::string const& _str);
+        
+        void Clear();
+        
+        // whether patches are run through OptimizePatch. a change
+        // empties the cache
+        void SetOptimize(bool _optimize);
+        bool Optimize() const;
+        
+        std::size_t Size() const;
+        std::size_t Hits() const;
+        std::size_t Misses() const;
+        
+        static std::string Normalize(std::string const& _str);
+        
+    private:
+        typedef boost::recursive_mutex mutex_type;
+        typedef mutex_type::scoped_lock lock_type;
+        typedef std::pair<std::string, PrototypePtr> EntryType;
+        typedef std::list<EntryType> ListType;
+        
+        std::size_t m_capacity;
+        ListType m_entries;   // most recently used first
+        std::unordered_map<std::string, ListType::iterator> m_index;
+        std::size_t m_hits;
+        std::size_t m_misses;
+        bool m_optimize;
+        mutable mutex_type m_mutex;
+    };
+}//---- namespace
+
+#endif
+
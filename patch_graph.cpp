@@ -0,0 +1,87 @@
+//-----------------------------------------------------------
+//    patch_graph.cpp
+//-----------------------------------------------------------
+
+#include "patch_graph.h"
+#include "lfo.h"
+
+namespace TSynth{
+    // made by the parser only, never from a compose string
+    std::string const NodeRef::tsynth_mod_key = "NodeRef";
+
+    SynthModBasePtr MakeNodeRef()
+    {
+        return std::make_shared<NullaryMod<NodeRef>>();
+    }
+
+    //-----------------------------------------------------------
+    //    PatchLinks
+    //-----------------------------------------------------------
+    std::size_t const PatchLinks::npos;
+    
+    bool PatchLinks::Empty() const
+    {
+        for(std::size_t i = 0; i < ahead.size(); ++i){
+            if(ahead[i]) return false;
+        }
+        return true;
+    }
+
+    void PatchLinks::InsertRoot()
+    {
+        for(std::size_t i = 0; i < refs.size(); ++i){
+            if(refs[i] != npos) ++refs[i];
+        }
+        refs.insert(refs.begin(), npos);
+        ports.insert(ports.begin(), Port{npos, 0.0});
+        ahead.insert(ahead.begin(), false);
+    }
+
+    //-----------------------------------------------------------
+    //    PatchGraph
+    //-----------------------------------------------------------
+    PatchGraph::PatchGraph(std::size_t _nodes)
+        : m_state(std::make_shared<State>())
+    {
+        m_state->values.assign(_nodes, 0.0);
+        m_state->countdown = 0;
+    }
+
+    void PatchGraph::AddNode(Node const& _node)
+    {
+        m_state->nodes.push_back(_node);
+    }
+
+    void PatchGraph::AddPort(Port const& _port)
+    {
+        m_state->ports.push_back(_port);
+    }
+
+    void PatchGraph::SetRoot(std::function<Real(void)> const& _root)
+    {
+        m_state->root = _root;
+    }
+
+    Real PatchGraph::operator()() const
+    {
+        State& s = *m_state;
+        for(std::size_t i = 0, n = s.nodes.size(); i < n; ++i){
+            Node const& node = s.nodes[i];
+            if(node.lfo){
+                s.values[node.node] = node.lfo->Current();
+                node.function();
+            }else{
+                s.values[node.node] = node.function();
+            }
+        }
+        if(s.countdown == 0){
+            s.countdown = Constants::param_ramp_chunk;
+            for(std::size_t i = 0, n = s.ports.size(); i < n; ++i){
+                Port const& port = s.ports[i];
+                port.mod->SetParam(port.param, *port.base + port.depth * s.values[port.node]);
+            }
+        }
+        --s.countdown;
+        return s.root();
+    }
+}//---- namespace
@@ -0,0 +1,161 @@
+//-----------------------------------------------------------
+//    patch graph
+//-----------------------------------------------------------
+#ifndef SYNTH_PATCH_GRAPH_H
+#define SYNTH_PATCH_GRAPH_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "type.h"
+#include "synth_mod.h"
+
+namespace TSynth{
+    class SynthLFO;
+
+    //-----------------------------------------------------------
+    //    class NodeRef
+    //        the place of a $name in the mod tree. it stands for
+    //        the node it names and is never played itself; the
+    //        graph reads the value that node took this sample.
+    //-----------------------------------------------------------
+    class NodeRef
+    {
+    public:
+        typedef Real result_type;
+
+        inline Real operator()() const
+        { return 0.0; }
+
+        TSYNTH_USE_AS_MOD
+    };
+
+    //-----------------------------------------------------------
+    //    struct PatchLinks
+    //        what a patch says beyond the tree, one entry per node
+    //        in preorder:
+    //        refs, the node a $name stands for, npos if none.
+    //        ports, the parameter of the parent a node drives,
+    //        param npos for a node that is a signal input.
+    //        ahead, the nodes run once per sample before the root,
+    //        i.e. the ones named by a $name and the ports.
+    //        the links of a patch are shared by its voices.
+    //-----------------------------------------------------------
+    struct PatchLinks
+    {
+        static std::size_t const npos = std::size_t(-1);
+
+        struct Port
+        {
+            std::size_t param;
+            Real depth;
+        };
+
+        std::vector<std::size_t> refs;
+        std::vector<Port> ports;
+        std::vector<bool> ahead;
+
+        inline bool IsPort(std::size_t _node) const
+        { return ports[_node].param != npos; }
+
+        // true if the patch has neither a $name nor a port
+        bool Empty() const;
+
+        // adds an entry for a new node in front of the root
+        void InsertRoot();
+    };
+
+    typedef std::shared_ptr<PatchLinks const> PatchLinksPtr;
+
+    //-----------------------------------------------------------
+    //    struct PortBase
+    //        the value a port adds to, one per port of a voice.
+    //        it starts as the parameter of the patch; param and
+    //        modmap move it in place of the parameter itself,
+    //        which the port sets again every few samples.
+    //-----------------------------------------------------------
+    struct PortBase
+    {
+        std::size_t node;
+        std::size_t param;
+        Real value;
+    };
+
+    typedef std::shared_ptr<std::vector<PortBase>> PortBasesPtr;
+
+    //-----------------------------------------------------------
+    //    class PatchGraph
+    //        the graph of a patch with links. every sample the
+    //        nodes ahead are run once, inputs first, and keep
+    //        their value for whoever reads them; the ports then
+    //        set their parameter every Constants::param_ramp_chunk
+    //        samples, to base + depth * value, and last the root
+    //        is run. copies share their state, as copies of a
+    //        MonoSynth share their mods.
+    //-----------------------------------------------------------
+    class PatchGraph
+    {
+    public:
+        struct Node
+        {
+            std::function<Real(void)> function;
+            std::size_t node;
+            // an lfo gives its control value, it plays silence
+            SynthLFO* lfo;
+        };
+
+        struct Port
+        {
+            std::size_t node;
+            SynthModBase* mod;
+            std::size_t param;
+            // the PortBase of the port, kept by the voice
+            Real const* base;
+            Real depth;
+        };
+
+        // _nodes is the number of nodes in the tree
+        explicit PatchGraph(std::size_t _nodes);
+
+        // where the value of _node is kept, valid as long as the graph
+        inline Real const* ValueOf(std::size_t _node) const
+        { return &m_state->values[_node]; }
+
+        // in order, inputs before the nodes that read them
+        void AddNode(Node const& _node);
+        void AddPort(Port const& _port);
+        void SetRoot(std::function<Real(void)> const& _root);
+
+        Real operator()() const;
+
+    private:
+        struct State
+        {
+            std::vector<Real> values;
+            std::vector<Node> nodes;
+            std::vector<Port> ports;
+            std::function<Real(void)> root;
+            std::size_t countdown;
+        };
+
+        std::shared_ptr<State> m_state;
+    };
+
+    //-----------------------------------------------------------
+    //    PatchValue
+    //        the function at every place of a node run ahead
+    //-----------------------------------------------------------
+    struct PatchValue
+    {
+        Real const* value;
+
+        inline Real operator()() const
+        { return *value; }
+    };
+
+    SynthModBasePtr MakeNodeRef();
+}//---- namespace
+
+#endif
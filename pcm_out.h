@@ -0,0 +1,39 @@
+//-----------------------------------------------------------
+//    pcm_out
+//-----------------------------------------------------------
+#ifndef SYKES_PCM_OUT_H
+#define SYKES_PCM_OUT_H
+
+#include <cstddef>
+#include <vector>
+#include <functional>
+#include "pcm_statistics.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class pcm_out
+    //        interface of an audio output backend. the backend owns
+    //        the worker thread and calls the callback once per
+    //        period; the callback hands the rendered interleaved
+    //        stereo frames back through write_buffer().
+    //-----------------------------------------------------------
+    class pcm_out
+    {
+    public:
+        typedef float buffer_format_type;
+
+        virtual ~pcm_out(){}
+
+        virtual void start() = 0;
+        virtual void stop() = 0;
+
+        virtual void set_callback(std::function<void(void)> const& _f) = 0;
+        virtual bool is_running() const = 0;
+        virtual std::size_t buffer_size() const = 0;
+        virtual std::size_t sample_rate() const = 0;
+        virtual void write_buffer(std::vector<buffer_format_type> const& _data) = 0;
+        virtual pcm_statistics_snapshot statistics() const = 0;
+    };
+}//----
+#endif
@@ -0,0 +1,59 @@
+//-----------------------------------------------------------
+//    pcm_out_factory.cpp
+//-----------------------------------------------------------
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include "pcm_out_factory.h"
+#include "clocked_pcm_out.h"
+#include "wav_pcm_out.h"
+#include "shm_pcm_out.h"
+#ifdef HAVE_ALSA
+#include "alsa/alsa_pcm_out.h"
+#endif
+
+namespace sykes{
+
+    std::unique_ptr<pcm_out> make_pcm_out(std::string const& _spec,
+        std::size_t _sample_rate, std::size_t _buffer_size)
+    {
+        std::string spec = _spec;
+        double speed = 1.0;
+        {
+            std::string::size_type const at = spec.rfind('@');
+            if(at != std::string::npos){
+                try{
+                    speed = boost::lexical_cast<double>(spec.substr(at + 1));
+                }
+                catch(boost::bad_lexical_cast const&){
+                    throw std::runtime_error("make_pcm_out() bad speed in " + _spec);
+                }
+                spec.erase(at);
+            }
+        }
+        
+        std::string kind = spec, arg;
+        {
+            std::string::size_type const colon = spec.find(':');
+            if(colon != std::string::npos){
+                kind = spec.substr(0, colon);
+                arg = spec.substr(colon + 1);
+            }
+        }
+        
+        if(kind == "alsa"){
+#ifdef HAVE_ALSA
+            return std::unique_ptr<pcm_out>(new alsa_pcm_out(_sample_rate, _buffer_size));
+#else
+            throw std::runtime_error("make_pcm_out() built without alsa");
+#endif
+        }
+        if(kind == "null")
+            return std::unique_ptr<pcm_out>(new null_pcm_out(_sample_rate, _buffer_size, speed));
+        if(kind == "wav" && !arg.empty())
+            return std::unique_ptr<pcm_out>(new wav_pcm_out(arg, _sample_rate, _buffer_size, speed));
+        if(kind == "shm" && !arg.empty())
+            return std::unique_ptr<pcm_out>(new shm_pcm_out(arg, _sample_rate, _buffer_size, speed));
+        
+        throw std::runtime_error("make_pcm_out() unknown output " + _spec);
+    }
+}//----
@@ -0,0 +1,27 @@
+//-----------------------------------------------------------
+//    pcm_out_factory
+//-----------------------------------------------------------
+#ifndef SYKES_PCM_OUT_FACTORY_H
+#define SYKES_PCM_OUT_FACTORY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "pcm_out.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    make_pcm_out
+    //        _spec is one of
+    //            alsa
+    //            null
+    //            wav:<path>
+    //            shm:<name>
+    //        the clock driven ones take an optional "@<speed>"
+    //        suffix, "@0" renders as fast as possible.
+    //-----------------------------------------------------------
+    std::unique_ptr<pcm_out> make_pcm_out(std::string const& _spec,
+        std::size_t _sample_rate, std::size_t _buffer_size);
+}//----
+#endif
@@ -0,0 +1,159 @@
+//-----------------------------------------------------------
+//    pcm_statistics
+//-----------------------------------------------------------
+#ifndef SYKES_PCM_STATISTICS_H
+#define SYKES_PCM_STATISTICS_H
+
+#include <time.h>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    pcm_statistics_snapshot
+    //-----------------------------------------------------------
+    struct pcm_statistics_snapshot
+    {
+        // callback durations in tenths of the period budget,
+        // the last bin collects everything at or above 150%
+        static std::size_t const histogram_bins = 16;
+        static std::size_t const xrun_history = 8;
+
+        std::uint64_t periods;
+        std::uint64_t xruns;
+        std::uint64_t short_writes;
+        std::uint64_t recoveries;
+        std::uint64_t recovery_failures;
+        std::uint64_t deadline_misses;
+        std::uint64_t budget_ns;
+        std::uint64_t max_callback_ns;
+        std::uint64_t total_callback_ns;
+        std::array<std::uint64_t, histogram_bins> histogram;
+        // wall clock time of the latest xruns in microseconds, newest first
+        std::array<std::int64_t, xrun_history> last_xruns;
+        std::size_t last_xrun_count;
+    };
+
+    //-----------------------------------------------------------
+    //    pcm_statistics
+    //        written by the pcm worker thread, read from anywhere.
+    //        every member is a relaxed atomic so that recording
+    //        never takes a lock on the audio path.
+    //-----------------------------------------------------------
+    class pcm_statistics
+    {
+    public:
+        static std::size_t const histogram_bins = pcm_statistics_snapshot::histogram_bins;
+        static std::size_t const xrun_history = pcm_statistics_snapshot::xrun_history;
+
+        pcm_statistics()
+            : m_periods(0), m_xruns(0), m_short_writes(0),
+            m_recoveries(0), m_recovery_failures(0), m_deadline_misses(0),
+            m_budget_ns(0), m_max_callback_ns(0), m_total_callback_ns(0),
+            m_xrun_index(0)
+        {
+            for(std::size_t i = 0; i < histogram_bins; ++i) m_histogram[i] = 0;
+            for(std::size_t i = 0; i < xrun_history; ++i) m_last_xruns[i] = 0;
+        }
+
+        inline static std::uint64_t monotonic_ns()
+        {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return std::uint64_t(ts.tv_sec) * 1000000000ULL + std::uint64_t(ts.tv_nsec);
+        }
+
+        inline static std::int64_t realtime_us()
+        {
+            timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return std::int64_t(ts.tv_sec) * 1000000LL + std::int64_t(ts.tv_nsec / 1000);
+        }
+
+        inline void set_budget(std::size_t _frames, std::size_t _sample_rate)
+        {
+            if(_sample_rate == 0) return;
+            m_budget_ns.store(std::uint64_t(_frames) * 1000000000ULL / _sample_rate,
+                std::memory_order_relaxed);
+        }
+
+        inline void record_callback(std::uint64_t _ns)
+        {
+            m_periods.fetch_add(1, std::memory_order_relaxed);
+            m_total_callback_ns.fetch_add(_ns, std::memory_order_relaxed);
+            if(_ns > m_max_callback_ns.load(std::memory_order_relaxed))
+                m_max_callback_ns.store(_ns, std::memory_order_relaxed);
+
+            std::uint64_t const budget = m_budget_ns.load(std::memory_order_relaxed);
+            std::size_t bin = histogram_bins - 1;
+            if(budget != 0){
+                std::uint64_t const tenth = _ns * 10 / budget;
+                if(tenth < histogram_bins - 1) bin = std::size_t(tenth);
+                if(_ns > budget) m_deadline_misses.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_histogram[bin].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        inline void record_xrun()
+        {
+            m_xruns.fetch_add(1, std::memory_order_relaxed);
+            std::size_t const i = m_xrun_index.fetch_add(1, std::memory_order_relaxed);
+            m_last_xruns[i % xrun_history].store(realtime_us(), std::memory_order_relaxed);
+        }
+
+        inline void record_short_write()
+        { m_short_writes.fetch_add(1, std::memory_order_relaxed); }
+
+        inline void record_recovery(bool _succeeded)
+        {
+            if(_succeeded) m_recoveries.fetch_add(1, std::memory_order_relaxed);
+            else m_recovery_failures.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        pcm_statistics_snapshot snapshot() const
+        {
+            pcm_statistics_snapshot s;
+            s.periods = m_periods.load(std::memory_order_relaxed);
+            s.xruns = m_xruns.load(std::memory_order_relaxed);
+            s.short_writes = m_short_writes.load(std::memory_order_relaxed);
+            s.recoveries = m_recoveries.load(std::memory_order_relaxed);
+            s.recovery_failures = m_recovery_failures.load(std::memory_order_relaxed);
+            s.deadline_misses = m_deadline_misses.load(std::memory_order_relaxed);
+            s.budget_ns = m_budget_ns.load(std::memory_order_relaxed);
+            s.max_callback_ns = m_max_callback_ns.load(std::memory_order_relaxed);
+            s.total_callback_ns = m_total_callback_ns.load(std::memory_order_relaxed);
+            for(std::size_t i = 0; i < histogram_bins; ++i)
+                s.histogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+
+            std::size_t const index = m_xrun_index.load(std::memory_order_relaxed);
+            s.last_xrun_count = (index < xrun_history) ? index : xrun_history;
+            for(std::size_t i = 0; i < xrun_history; ++i){
+                s.last_xruns[i] = (i < s.last_xrun_count)
+                    ? m_last_xruns[(index - 1 - i) % xrun_history].load(std::memory_order_relaxed)
+                    : 0;
+            }
+            return s;
+        }
+
+    private:
+        std::atomic<std::uint64_t> m_periods;
+        std::atomic<std::uint64_t> m_xruns;
+        std::atomic<std::uint64_t> m_short_writes;
+        std::atomic<std::uint64_t> m_recoveries;
+        std::atomic<std::uint64_t> m_recovery_failures;
+        std::atomic<std::uint64_t> m_deadline_misses;
+        std::atomic<std::uint64_t> m_budget_ns;
+        std::atomic<std::uint64_t> m_max_callback_ns;
+        std::atomic<std::uint64_t> m_total_callback_ns;
+        std::array<std::atomic<std::uint64_t>, histogram_bins> m_histogram;
+        std::array<std::atomic<std::int64_t>, xrun_history> m_last_xruns;
+        std::atomic<std::size_t> m_xrun_index;
+
+        pcm_statistics(pcm_statistics const&);
+        pcm_statistics& operator=(pcm_statistics const&);
+    };
+}//----
+#endif
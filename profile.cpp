@@ -0,0 +1,82 @@
+//-----------------------------------------------------------
+//    profile.cpp
+//-----------------------------------------------------------
+#include <algorithm>
+#include "profile.h"
+
+namespace TSynth{
+
+    RenderProfile::RenderProfile()
+        : m_mods(), m_voices(), m_blocks(0), m_reset(false)
+    {
+        Clear();
+    }
+
+    void RenderProfile::Clear()
+    {
+        for(std::size_t i = 0; i < max_mod_types; ++i){
+            m_mods[i].name.store(0, std::memory_order_relaxed);
+            m_mods[i].ticks.store(0, std::memory_order_relaxed);
+        }
+        for(std::size_t i = 0; i < max_voices; ++i)
+            m_voices[i].store(0, std::memory_order_relaxed);
+        m_blocks.store(0, std::memory_order_relaxed);
+    }
+
+    void RenderProfile::BeginBlock()
+    {
+        if(m_reset.exchange(false, std::memory_order_acquire)) Clear();
+        m_blocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // mod names are the static keys of the mod classes, so the
+    // pointer tells the type. types past max_mod_types are not counted.
+    void RenderProfile::AddMod(std::string const* _name, ProfileTicks _ticks)
+    {
+        for(std::size_t i = 0; i < max_mod_types; ++i){
+            ModSlot& slot = m_mods[i];
+            std::string const* const name = slot.name.load(std::memory_order_relaxed);
+            if(name == 0){
+                slot.ticks.store(_ticks, std::memory_order_relaxed);
+                slot.name.store(_name, std::memory_order_release);
+                return;
+            }
+            if(name == _name){
+                slot.ticks.fetch_add(_ticks, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    void RenderProfile::AddVoice(std::size_t _voice, ProfileTicks _ticks)
+    {
+        if(_voice < max_voices)
+            m_voices[_voice].fetch_add(_ticks, std::memory_order_relaxed);
+    }
+
+    void RenderProfile::RequestReset()
+    {
+        m_reset.store(true, std::memory_order_release);
+    }
+
+    RenderProfile::Snapshot RenderProfile::GetSnapshot() const
+    {
+        Snapshot s;
+        s.voices.fill(0);
+        s.blocks = 0;
+        if(m_reset.load(std::memory_order_acquire)) return s;
+
+        for(std::size_t i = 0; i < max_mod_types; ++i){
+            std::string const* const name = m_mods[i].name.load(std::memory_order_acquire);
+            if(name == 0) break;
+            s.mods.push_back(std::make_pair(*name, m_mods[i].ticks.load(std::memory_order_relaxed)));
+        }
+        std::sort(s.mods.begin(), s.mods.end(),
+            [](std::pair<std::string, ProfileTicks> const& _a, std::pair<std::string, ProfileTicks> const& _b)
+            { return _a.second > _b.second; });
+        for(std::size_t i = 0; i < max_voices; ++i)
+            s.voices[i] = m_voices[i].load(std::memory_order_relaxed);
+        s.blocks = m_blocks.load(std::memory_order_relaxed);
+        return s;
+    }
+}//---- namespace
@@ -0,0 +1,144 @@
+//-----------------------------------------------------------
+//    RenderProfile
+//-----------------------------------------------------------
+#ifndef SYNTH_PROFILE_H
+#define SYNTH_PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <functional>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "type.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    ProfileClock
+    //        the time stamp counter where there is one, else
+    //        nanoseconds. only ratios are shown, so the unit
+    //        does not matter.
+    //-----------------------------------------------------------
+    typedef std::uint64_t ProfileTicks;
+
+    inline ProfileTicks ProfileClock()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ProfileTicks(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+#endif
+    }
+
+    //-----------------------------------------------------------
+    //    NodeProfile
+    //        one node of a voice's graph. ticks is the time spent
+    //        in the node including its inputs.
+    //-----------------------------------------------------------
+    struct NodeProfile
+    {
+        std::string const* name;
+        std::size_t parent;
+        ProfileTicks ticks;
+    };
+
+    //-----------------------------------------------------------
+    //    TimedFunction
+    //        a node function of the profiled graph
+    //-----------------------------------------------------------
+    class TimedFunction
+    {
+    public:
+        TimedFunction(std::function<Real(void)> const& _f, NodeProfile* _node)
+            : m_function(_f), m_node(_node)
+        {}
+
+        inline Real operator()()
+        {
+            ProfileTicks const start = ProfileClock();
+            Real const r = m_function();
+            m_node->ticks += ProfileClock() - start;
+            return r;
+        }
+
+    private:
+        std::function<Real(void)> m_function;
+        NodeProfile* m_node;
+    };
+
+    //-----------------------------------------------------------
+    //    class RenderProfile
+    //        sums of the profiled blocks per mod type and per
+    //        voice. the mod times are exclusive of the inputs.
+    //        written by the audio thread only, a reset is
+    //        requested and carried out there.
+    //-----------------------------------------------------------
+    class RenderProfile
+    {
+    public:
+        static std::size_t const max_mod_types = 16;
+        static std::size_t const max_voices = 32;
+
+        struct Snapshot
+        {
+            // by mod name, most expensive first
+            std::vector<std::pair<std::string, ProfileTicks>> mods;
+            std::array<ProfileTicks, max_voices> voices;
+            std::uint64_t blocks;
+
+            ProfileTicks ModTotal() const
+            {
+                ProfileTicks t = 0;
+                for(std::size_t i = 0; i < mods.size(); ++i) t += mods[i].second;
+                return t;
+            }
+
+            ProfileTicks VoiceTotal() const
+            {
+                ProfileTicks t = 0;
+                for(std::size_t i = 0; i < voices.size(); ++i) t += voices[i];
+                return t;
+            }
+        };
+
+        RenderProfile();
+
+        // audio thread
+        void BeginBlock();
+        void AddMod(std::string const* _name, ProfileTicks _ticks);
+        void AddVoice(std::size_t _voice, ProfileTicks _ticks);
+
+        // anywhere
+        void RequestReset();
+        Snapshot GetSnapshot() const;
+
+    private:
+        struct ModSlot
+        {
+            std::atomic<std::string const*> name;
+            std::atomic<ProfileTicks> ticks;
+        };
+
+        std::array<ModSlot, max_mod_types> m_mods;
+        std::array<std::atomic<ProfileTicks>, max_voices> m_voices;
+        std::atomic<std::uint64_t> m_blocks;
+        std::atomic<bool> m_reset;
+
+        void Clear();
+
+        RenderProfile(RenderProfile const&);
+        RenderProfile& operator=(RenderProfile const&);
+    };
+}//---- namespace
+
+#endif
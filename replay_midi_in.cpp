@@ -0,0 +1,149 @@
+//-----------------------------------------------------------
+//    replay_midi_in.cpp
+//-----------------------------------------------------------
+#include <time.h>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include "replay_midi_in.h"
+
+namespace sykes{
+
+    namespace{
+        inline std::uint64_t monotonic_ns()
+        {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return std::uint64_t(ts.tv_sec) * 1000000000ULL + std::uint64_t(ts.tv_nsec);
+        }
+
+        bool event_time_less(replay_midi_in::event const& _a, replay_midi_in::event const& _b)
+        {
+            return _a.time < _b.time;
+        }
+    }
+
+    replay_midi_in::replay_midi_in(std::string const& _path, double _speed, bool _loop)
+        :
+        m_running(false),
+        m_speed(_speed),
+        m_loop(_loop),
+        m_events(),
+        m_on_midi_event(),
+        m_worker(),
+        m_mutex(),
+        m_running_mutex()
+    {
+        load(_path);
+    }
+
+    replay_midi_in::~replay_midi_in()
+    {
+        stop();
+    }
+
+    void replay_midi_in::load(std::string const& _path)
+    {
+        std::ifstream in(_path.c_str());
+        if(!in) throw std::runtime_error("replay_midi_in::load() cannot open " + _path);
+
+        std::string line;
+        std::size_t line_number = 0;
+        while(std::getline(in, line)){
+            ++line_number;
+            std::string::size_type const comment = line.find('#');
+            if(comment != std::string::npos) line.erase(comment);
+
+            std::istringstream is(line);
+            double time = 0.0;
+            if(!(is >> time)) continue;
+
+            std::uint8_t bytes[3] = {0, 0, 0};
+            std::size_t count = 0;
+            unsigned int b = 0;
+            while(count < 3 && (is >> std::hex >> b)){
+                bytes[count] = static_cast<std::uint8_t>(b & 0xFF);
+                ++count;
+            }
+            if(count == 0 || bytes[0] < 0x80){
+                std::ostringstream os;
+                os << "replay_midi_in::load() bad event at " << _path << ":" << line_number;
+                throw std::runtime_error(os.str());
+            }
+            event const ev = {time, midi::make_message(bytes)};
+            m_events.push_back(ev);
+        }
+        std::stable_sort(m_events.begin(), m_events.end(), &event_time_less);
+    }
+
+    void replay_midi_in::set_on_midi_event(handler_type const& _f)
+    {
+        lock_type lk(m_mutex);
+        m_on_midi_event = _f;
+    }
+
+    void replay_midi_in::start()
+    {
+        lock_type lk(m_mutex);
+        lock_type lk2(m_running_mutex);
+        if(m_running) return;
+
+        m_running = true;
+        m_worker = std::unique_ptr<thread_type>(new thread_type(&replay_midi_in::routine, this));
+    }
+
+    void replay_midi_in::stop()
+    {
+        {
+            lock_type lk(m_running_mutex);
+            if(!m_running) return;
+            m_running = false;
+        }
+        m_worker->join();
+    }
+
+    bool replay_midi_in::is_running() const
+    {
+        lock_type lk(m_running_mutex);
+        return m_running;
+    }
+
+    // sleeps in short slices so that stop() is never kept waiting
+    // for long, returns false when stopped meanwhile.
+    bool replay_midi_in::wait_until(std::uint64_t _ns) const
+    {
+        std::uint64_t const slice = 100000000ULL;
+        while(1){
+            if(!is_running()) return false;
+            std::uint64_t const now = monotonic_ns();
+            if(now >= _ns) return true;
+            std::uint64_t const wait = std::min(_ns - now, slice);
+            timespec ts;
+            ts.tv_sec = time_t(wait / 1000000000ULL);
+            ts.tv_nsec = long(wait % 1000000000ULL);
+            nanosleep(&ts, 0);
+        }
+    }
+
+    void replay_midi_in::routine()
+    {
+        if(m_events.empty()) return;
+        do{
+            std::uint64_t const origin = monotonic_ns();
+            double const first = m_events.front().time;
+            for(std::size_t i = 0, sz = m_events.size(); i < sz; ++i){
+                if(m_speed > 0.0){
+                    double const offset = (m_events[i].time - first) / m_speed;
+                    if(!wait_until(origin + std::uint64_t(offset * 1.0e9))) return;
+                }else if(!is_running()){
+                    return;
+                }
+                lock_type lk(m_mutex);
+                if(m_on_midi_event)
+                    m_on_midi_event(m_events[i].message, boost::posix_time::microsec_clock::universal_time());
+            }
+        }while(m_loop && is_running());
+    }
+}//----
@@ -0,0 +1,63 @@
+//-----------------------------------------------------------
+//    replay_midi_in
+//-----------------------------------------------------------
+#ifndef SYKES_REPLAY_MIDI_IN_H
+#define SYKES_REPLAY_MIDI_IN_H
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "midi_in.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class replay_midi_in
+    //        plays back a timestamped event log. one event per line:
+    //
+    //            <seconds> <status> [<data1> [<data2>]]
+    //
+    //        the bytes are hexadecimal, '#' starts a comment.
+    //        _speed scales the time line, 0 sends everything at once.
+    //        with _loop the log starts over after the last event.
+    //-----------------------------------------------------------
+    class replay_midi_in
+        : public midi_in
+    {
+    public:
+        struct event
+        {
+            double time;
+            midi::message message;
+        };
+
+        replay_midi_in(std::string const& _path, double _speed = 1.0, bool _loop = false);
+        ~replay_midi_in();
+
+        void start();
+        void stop();
+        bool is_running() const;
+        void set_on_midi_event(handler_type const& _f);
+
+    private:
+        typedef boost::recursive_mutex mutex_type;
+        typedef mutex_type::scoped_lock lock_type;
+        typedef boost::thread thread_type;
+
+        bool m_running;
+        double m_speed;
+        bool m_loop;
+        std::vector<event> m_events;
+        handler_type m_on_midi_event;
+        std::unique_ptr<thread_type> m_worker;
+        mutex_type mutable m_mutex;
+        mutex_type mutable m_running_mutex;
+
+        void load(std::string const& _path);
+        void routine();
+        bool wait_until(std::uint64_t _ns) const;
+    };
+}//----
+#endif
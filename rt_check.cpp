@@ -0,0 +1,318 @@
+//-----------------------------------------------------------
+//    rt_check.cpp
+//        compiled to nothing unless TSYNTH_RTCHECK is defined.
+//        the interposers below replace the libc symbols for the
+//        whole program and pass every call on; only calls made
+//        inside an rt_scope are counted.
+//-----------------------------------------------------------
+#ifdef TSYNTH_RTCHECK
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+#include "rt_check.h"
+
+extern "C"{
+    void* __libc_malloc(std::size_t);
+    void* __libc_calloc(std::size_t, std::size_t);
+    void* __libc_realloc(void*, std::size_t);
+    void* __libc_memalign(std::size_t, std::size_t);
+    void __libc_free(void*);
+}
+
+namespace sykes{
+
+    namespace{
+        // stack traces printed per run, the counts go on regardless
+        std::uint64_t const max_traces = 8;
+        int const max_frames = 32;
+
+        __thread unsigned t_depth = 0;
+        // set while the checker itself runs, its own calls pass
+        __thread bool t_reporting = false;
+
+        std::atomic<std::uint64_t> g_counts[rt_violation_kinds];
+        std::atomic<std::uint64_t> g_scopes;
+        std::atomic<std::uint64_t> g_traces;
+
+        inline bool in_rt_scope()
+        {
+            return t_depth != 0 && !t_reporting;
+        }
+
+        void report(rt_violation _v, char const* _call)
+        {
+            t_reporting = true;
+            g_counts[static_cast<std::size_t>(_v)].fetch_add(1, std::memory_order_relaxed);
+            if(g_traces.fetch_add(1, std::memory_order_relaxed) < max_traces){
+                char line[128];
+                int const len = std::snprintf(line, sizeof(line),
+                    "rtcheck: %s in real-time scope (%s)\n", _call, rt_violation_name(_v));
+                if(len > 0) ::write(2, line, std::strlen(line));
+                void* frames[max_frames];
+                int const n = ::backtrace(frames, max_frames);
+                // skip report() and the interposer
+                if(n > 2) ::backtrace_symbols_fd(frames + 2, n - 2, 2);
+            }
+            t_reporting = false;
+        }
+
+        // the next definition of _name, looked up on first use
+        template<typename Function>
+        inline Function next(Function& _cache, char const* _name)
+        {
+            if(!_cache){
+                bool const reporting = t_reporting;
+                t_reporting = true;
+                _cache = reinterpret_cast<Function>(::dlsym(RTLD_NEXT, _name));
+                t_reporting = reporting;
+            }
+            return _cache;
+        }
+
+        // the same for a symbol with versions, where dlsym gives the
+        // oldest one. falls back to dlsym where _version is unknown
+        template<typename Function>
+        inline Function next(Function& _cache, char const* _name, char const* _version)
+        {
+            if(!_cache){
+                bool const reporting = t_reporting;
+                t_reporting = true;
+                _cache = reinterpret_cast<Function>(::dlvsym(RTLD_NEXT, _name, _version));
+                if(!_cache) _cache = reinterpret_cast<Function>(::dlsym(RTLD_NEXT, _name));
+                t_reporting = reporting;
+            }
+            return _cache;
+        }
+
+        // as libc decides whether open was given a mode
+        inline bool open_has_mode(int _flags)
+        {
+#ifdef O_TMPFILE
+            if((_flags & O_TMPFILE) == O_TMPFILE) return true;
+#endif
+            return (_flags & O_CREAT) != 0;
+        }
+    }
+
+    rt_scope::rt_scope()
+    {
+        if(t_depth++ == 0) g_scopes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    rt_scope::~rt_scope()
+    {
+        --t_depth;
+    }
+
+    rt_check_snapshot rt_check_statistics()
+    {
+        rt_check_snapshot s;
+        for(std::size_t i = 0; i < rt_violation_kinds; ++i)
+            s.counts[i] = g_counts[i].load(std::memory_order_relaxed);
+        s.scopes = g_scopes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void rt_check_reset()
+    {
+        for(std::size_t i = 0; i < rt_violation_kinds; ++i)
+            g_counts[i].store(0, std::memory_order_relaxed);
+        g_scopes.store(0, std::memory_order_relaxed);
+        g_traces.store(0, std::memory_order_relaxed);
+    }
+}//---- namespace
+
+//-----------------------------------------------------------
+//    interposers
+//-----------------------------------------------------------
+using sykes::rt_violation;
+using sykes::in_rt_scope;
+using sykes::report;
+using sykes::next;
+using sykes::open_has_mode;
+
+extern "C"{
+    //---- memory
+    void* malloc(std::size_t _size)
+    {
+        if(in_rt_scope()) report(rt_violation::ALLOC, "malloc");
+        return __libc_malloc(_size);
+    }
+
+    void* calloc(std::size_t _n, std::size_t _size)
+    {
+        if(in_rt_scope()) report(rt_violation::ALLOC, "calloc");
+        return __libc_calloc(_n, _size);
+    }
+
+    void* realloc(void* _p, std::size_t _size)
+    {
+        if(in_rt_scope()) report(rt_violation::ALLOC, "realloc");
+        return __libc_realloc(_p, _size);
+    }
+
+    int posix_memalign(void** _p, std::size_t _align, std::size_t _size)
+    {
+        if(in_rt_scope()) report(rt_violation::ALLOC, "posix_memalign");
+        void* const p = __libc_memalign(_align, _size);
+        if(!p) return ENOMEM;
+        *_p = p;
+        return 0;
+    }
+
+    void* aligned_alloc(std::size_t _align, std::size_t _size)
+    {
+        if(in_rt_scope()) report(rt_violation::ALLOC, "aligned_alloc");
+        return __libc_memalign(_align, _size);
+    }
+
+    void* memalign(std::size_t _align, std::size_t _size)
+    {
+        if(in_rt_scope()) report(rt_violation::ALLOC, "memalign");
+        return __libc_memalign(_align, _size);
+    }
+
+    // deleting a null pointer is fine anywhere
+    void free(void* _p)
+    {
+        if(_p && in_rt_scope()) report(rt_violation::FREE, "free");
+        __libc_free(_p);
+    }
+
+    //---- locks
+    int pthread_mutex_lock(pthread_mutex_t* _m)
+    {
+        static int (*f)(pthread_mutex_t*) = 0;
+        if(in_rt_scope()) report(rt_violation::LOCK, "pthread_mutex_lock");
+        return next(f, "pthread_mutex_lock")(_m);
+    }
+
+    // does not block, but a lock taken is one the control thread
+    // may have to wait for
+    int pthread_mutex_trylock(pthread_mutex_t* _m)
+    {
+        static int (*f)(pthread_mutex_t*) = 0;
+        if(in_rt_scope()) report(rt_violation::LOCK, "pthread_mutex_trylock");
+        return next(f, "pthread_mutex_trylock")(_m);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* _c, pthread_mutex_t* _m)
+    {
+        static int (*f)(pthread_cond_t*, pthread_mutex_t*) = 0;
+        if(in_rt_scope()) report(rt_violation::LOCK, "pthread_cond_wait");
+        return next(f, "pthread_cond_wait", "GLIBC_2.3.2")(_c, _m);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* _c, pthread_mutex_t* _m, timespec const* _t)
+    {
+        static int (*f)(pthread_cond_t*, pthread_mutex_t*, timespec const*) = 0;
+        if(in_rt_scope()) report(rt_violation::LOCK, "pthread_cond_timedwait");
+        return next(f, "pthread_cond_timedwait", "GLIBC_2.3.2")(_c, _m, _t);
+    }
+
+    int sem_wait(sem_t* _s)
+    {
+        static int (*f)(sem_t*) = 0;
+        if(in_rt_scope()) report(rt_violation::LOCK, "sem_wait");
+        return next(f, "sem_wait")(_s);
+    }
+
+    //---- blocking system calls
+    int nanosleep(timespec const* _req, timespec* _rem)
+    {
+        static int (*f)(timespec const*, timespec*) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "nanosleep");
+        return next(f, "nanosleep")(_req, _rem);
+    }
+
+    int clock_nanosleep(clockid_t _clock, int _flags, timespec const* _req, timespec* _rem)
+    {
+        static int (*f)(clockid_t, int, timespec const*, timespec*) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "clock_nanosleep");
+        return next(f, "clock_nanosleep")(_clock, _flags, _req, _rem);
+    }
+
+    int usleep(useconds_t _usec)
+    {
+        static int (*f)(useconds_t) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "usleep");
+        return next(f, "usleep")(_usec);
+    }
+
+    ssize_t read(int _fd, void* _buf, std::size_t _n)
+    {
+        static ssize_t (*f)(int, void*, std::size_t) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "read");
+        return next(f, "read")(_fd, _buf, _n);
+    }
+
+    ssize_t write(int _fd, void const* _buf, std::size_t _n)
+    {
+        static ssize_t (*f)(int, void const*, std::size_t) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "write");
+        return next(f, "write")(_fd, _buf, _n);
+    }
+
+    // the mode is there only when the file may be created
+    int open(char const* _path, int _flags, ...)
+    {
+        static int (*f)(char const*, int, ...) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "open");
+        mode_t mode = 0;
+        if(open_has_mode(_flags)){
+            va_list args;
+            va_start(args, _flags);
+            mode = va_arg(args, mode_t);
+            va_end(args);
+        }
+        return next(f, "open")(_path, _flags, mode);
+    }
+
+    void* mmap(void* _addr, std::size_t _n, int _prot, int _flags, int _fd, off_t _offset)
+    {
+        static void* (*f)(void*, std::size_t, int, int, int, off_t) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "mmap");
+        return next(f, "mmap")(_addr, _n, _prot, _flags, _fd, _offset);
+    }
+
+    int poll(pollfd* _fds, nfds_t _n, int _timeout)
+    {
+        static int (*f)(pollfd*, nfds_t, int) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "poll");
+        return next(f, "poll")(_fds, _n, _timeout);
+    }
+
+    int select(int _n, fd_set* _r, fd_set* _w, fd_set* _e, timeval* _timeout)
+    {
+        static int (*f)(int, fd_set*, fd_set*, fd_set*, timeval*) = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "select");
+        return next(f, "select")(_n, _r, _w, _e, _timeout);
+    }
+
+    int sched_yield()
+    {
+        static int (*f)() = 0;
+        if(in_rt_scope()) report(rt_violation::SYSCALL, "sched_yield");
+        return next(f, "sched_yield")();
+    }
+}
+
+#endif
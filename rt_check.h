@@ -0,0 +1,98 @@
+//-----------------------------------------------------------
+//    rt_check
+//-----------------------------------------------------------
+#ifndef SYKES_RT_CHECK_H
+#define SYKES_RT_CHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    rt_check
+    //        a thread inside an rt_scope promises not to allocate,
+    //        lock or block. built with TSYNTH_RTCHECK (waf configure
+    //        --rtcheck) rt_check.cpp interposes malloc and friends,
+    //        pthread mutex locks, condition and semaphore waits and
+    //        blocking system calls, open and mmap among them; a call
+    //        made inside a scope is counted and the first few print
+    //        a stack trace to stderr. without the flag rt_scope is
+    //        empty and nothing is interposed.
+    //-----------------------------------------------------------
+    enum class rt_violation
+    {
+        ALLOC,
+        FREE,
+        LOCK,
+        SYSCALL,
+        NUM
+    };
+
+    static std::size_t const rt_violation_kinds = static_cast<std::size_t>(rt_violation::NUM);
+
+    inline char const* rt_violation_name(rt_violation _v)
+    {
+        switch(_v){
+            case rt_violation::ALLOC: return "alloc";
+            case rt_violation::FREE: return "free";
+            case rt_violation::LOCK: return "lock";
+            case rt_violation::SYSCALL: return "syscall";
+            default: return "";
+        }
+    }
+
+    struct rt_check_snapshot
+    {
+        std::array<std::uint64_t, rt_violation_kinds> counts;
+        std::uint64_t scopes;
+
+        std::uint64_t total() const
+        {
+            std::uint64_t t = 0;
+            for(std::size_t i = 0; i < counts.size(); ++i) t += counts[i];
+            return t;
+        }
+    };
+
+#ifdef TSYNTH_RTCHECK
+    bool const rt_check_enabled = true;
+
+    class rt_scope
+    {
+    public:
+        rt_scope();
+        ~rt_scope();
+    private:
+        rt_scope(rt_scope const&);
+        rt_scope& operator=(rt_scope const&);
+    };
+
+    rt_check_snapshot rt_check_statistics();
+    void rt_check_reset();
+#else
+    bool const rt_check_enabled = false;
+
+    class rt_scope
+    {
+    public:
+        rt_scope() {}
+    private:
+        rt_scope(rt_scope const&);
+        rt_scope& operator=(rt_scope const&);
+    };
+
+    inline rt_check_snapshot rt_check_statistics()
+    {
+        rt_check_snapshot s;
+        s.counts.fill(0);
+        s.scopes = 0;
+        return s;
+    }
+
+    inline void rt_check_reset() {}
+#endif
+}//---- namespace
+
+#endif
@@ -0,0 +1,222 @@
+//-----------------------------------------------------------
+//    sample_store.cpp
+//-----------------------------------------------------------
+#include <errno.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include "sample_store.h"
+#include "constants.h"
+
+namespace TSynth{
+
+    namespace{
+        std::atomic<std::uint64_t> underruns(0);
+
+        //-----------------------------------------------------------
+        //    Prefetcher
+        //        the one thread that fills every SampleStream. it
+        //        sleeps until Register, a Start or a freed chunk wakes
+        //        it, then tops up the rings that have a chunk free and
+        //        drops the streams nobody else holds any more. the
+        //        streams are filled outside the lock, from a copy of
+        //        the list.
+        //-----------------------------------------------------------
+        class Prefetcher
+        {
+        public:
+            typedef boost::mutex mutex_type;
+            typedef mutex_type::scoped_lock lock_type;
+
+            static Prefetcher& GetInstance()
+            {
+                static Prefetcher instance;
+                return instance;
+            }
+
+            ~Prefetcher()
+            {
+                m_running.store(false, std::memory_order_relaxed);
+                sem_post(&m_wake);
+                if(m_worker) m_worker->join();
+                sem_destroy(&m_wake);
+            }
+
+            void Register(std::shared_ptr<SampleStream> const& _stream)
+            {
+                {
+                    lock_type lk(m_mutex);
+                    m_streams.push_back(_stream);
+                    if(!m_worker){
+                        m_running.store(true, std::memory_order_relaxed);
+                        m_worker.reset(new boost::thread(&Prefetcher::Routine, this));
+                    }
+                }
+                Wake();
+            }
+
+            // any thread. a semaphore rather than a condition variable,
+            // whose notify takes a lock in the audio thread
+            void Wake()
+            {
+                if(!m_pending.exchange(true, std::memory_order_acq_rel))
+                    sem_post(&m_wake);
+            }
+
+        private:
+            std::vector<std::shared_ptr<SampleStream>> m_streams;
+            std::unique_ptr<boost::thread> m_worker;
+            std::atomic<bool> m_running;
+            std::atomic<bool> m_pending;
+            mutex_type m_mutex;
+            sem_t m_wake;
+
+            Prefetcher()
+                : m_streams(), m_worker(), m_running(false), m_pending(false), m_mutex()
+            {
+                sem_init(&m_wake, 0, 0);
+            }
+
+            void Routine()
+            {
+                std::vector<std::shared_ptr<SampleStream>> streams;
+                while(m_running.load(std::memory_order_relaxed)){
+                    m_pending.store(false, std::memory_order_release);
+                    {
+                        lock_type lk(m_mutex);
+                        m_streams.erase(std::remove_if(m_streams.begin(), m_streams.end(),
+                            [](std::shared_ptr<SampleStream> const& _s){ return _s.use_count() == 1; }),
+                            m_streams.end());
+                        streams = m_streams;
+                    }
+                    for(std::size_t i = 0; i < streams.size(); ++i)
+                        streams[i]->Fill();
+                    streams.clear();
+                    while(sem_wait(&m_wake) != 0 && errno == EINTR){}
+                }
+            }
+        };
+    }
+
+    //-----------------------------------------------------------
+    //    Sample
+    //-----------------------------------------------------------
+    std::shared_ptr<Sample const> Sample::Load(std::string const& _path)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::weak_ptr<Sample const>> samples;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::weak_ptr<Sample const>& entry = samples[_path];
+        std::shared_ptr<Sample const> sample = entry.lock();
+        if(!sample){
+            sample.reset(new Sample(_path));
+            entry = sample;
+        }
+        return sample;
+    }
+
+    // the head is decoded up front, so a note never waits for the
+    // file; a failed mlock (RLIMIT_MEMLOCK) leaves it unlocked
+    Sample::Sample(std::string const& _path)
+        : m_wav(_path), m_head(), m_locked(false)
+    {
+        std::size_t head = m_wav.frames();
+        if(head > Constants::sampler_head_frames) head = Constants::sampler_head_frames;
+        m_head.resize(head);
+        if(m_head.empty()) return;
+        m_wav.read(0, m_head.size(), 0, &m_head[0]);
+        m_wav.dont_need(0, m_head.size());
+        m_locked = (mlock(&m_head[0], m_head.size() * sizeof(float)) == 0);
+    }
+
+    Sample::~Sample()
+    {
+        if(m_locked) munlock(&m_head[0], m_head.size() * sizeof(float));
+    }
+
+    //-----------------------------------------------------------
+    //    SampleStream
+    //-----------------------------------------------------------
+    std::size_t const SampleStream::capacity = Constants::sampler_ring_frames;
+
+    SampleStream::SampleStream(std::vector<std::shared_ptr<Sample const>> const& _samples)
+        : m_samples(_samples),
+        m_ring(new float[capacity]()),
+        m_write(0), m_read(0),
+        m_request(0), m_request_epoch(0),
+        m_epoch_start(0), m_ready_epoch(0),
+        m_epoch(0), m_ready(false), m_start(0),
+        m_fill_epoch(0), m_fill_sample(_samples.size()), m_fill_position(0)
+    {
+        static_assert((Constants::sampler_ring_frames & (Constants::sampler_ring_frames - 1)) == 0,
+            "TSynth::SampleStream capacity must be a power of two");
+    }
+
+    void SampleStream::Start(std::size_t _sample)
+    {
+        m_request.store(_sample, std::memory_order_relaxed);
+        m_epoch = m_request_epoch.fetch_add(1, std::memory_order_release) + 1;
+        m_ready = false;
+        WakePrefetcher();
+    }
+
+    // a new request starts at the current write index, the audio
+    // thread moves its read index there when it sees the answer
+    void SampleStream::Fill()
+    {
+        std::uint32_t const epoch = m_request_epoch.load(std::memory_order_acquire);
+        std::size_t const write = m_write.load(std::memory_order_relaxed);
+        if(epoch != m_fill_epoch){
+            m_fill_epoch = epoch;
+            m_fill_sample = m_request.load(std::memory_order_relaxed);
+            m_fill_position = Constants::sampler_head_frames;
+            m_epoch_start.store(write, std::memory_order_relaxed);
+            m_ready_epoch.store(epoch, std::memory_order_release);
+        }
+        if(m_fill_sample >= m_samples.size()) return;
+
+        Sample const& sample = *m_samples[m_fill_sample];
+        if(m_fill_position >= sample.Frames()) return;
+        std::size_t const remaining = sample.Frames() - m_fill_position;
+        std::size_t const space = capacity - (write - m_read.load(std::memory_order_acquire));
+        std::size_t const n = std::min(space, remaining);
+        if(n < Constants::sampler_chunk_frames && n < remaining) return;
+
+        std::size_t const offset = write & (capacity - 1);
+        std::size_t const first = std::min(n, capacity - offset);
+        sample.Wav().read(m_fill_position, first, 0, &m_ring[offset]);
+        sample.Wav().read(m_fill_position + first, n - first, 0, &m_ring[0]);
+        m_write.store(write + n, std::memory_order_release);
+
+        // pages ahead are asked for now, pages behind are given back
+        // so a long sample never stays resident as a whole
+        sample.Wav().dont_need(m_fill_position, n);
+        m_fill_position += n;
+        sample.Wav().will_need(m_fill_position, capacity);
+    }
+
+    std::uint64_t SampleStream::Underruns()
+    {
+        return underruns.load(std::memory_order_relaxed);
+    }
+
+    void SampleStream::CountUnderrun()
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void SampleStream::WakePrefetcher()
+    {
+        Prefetcher::GetInstance().Wake();
+    }
+
+    void RegisterSampleStream(std::shared_ptr<SampleStream> const& _stream)
+    {
+        Prefetcher::GetInstance().Register(_stream);
+    }
+}//---- namespace
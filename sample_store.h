@@ -0,0 +1,149 @@
+//-----------------------------------------------------------
+//    sample store
+//-----------------------------------------------------------
+#ifndef SYNTH_SAMPLE_STORE_H
+#define SYNTH_SAMPLE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mapped_wav.h"
+#include "constants.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    class Sample
+    //        a wav file kept mapped, with its first
+    //        Constants::sampler_head_frames frames decoded and
+    //        locked in memory. the audio thread only ever reads the
+    //        head; what follows is streamed by the prefetch thread.
+    //        samples are shared by path.
+    //-----------------------------------------------------------
+    class Sample
+    {
+    public:
+        // throws std::runtime_error if the file cannot be read
+        static std::shared_ptr<Sample const> Load(std::string const& _path);
+
+        ~Sample();
+
+        inline std::size_t Frames() const
+        { return m_wav.frames(); }
+
+        inline std::size_t SampleRate() const
+        { return m_wav.sample_rate(); }
+
+        inline std::vector<float> const& Head() const
+        { return m_head; }
+
+        inline sykes::mapped_wav const& Wav() const
+        { return m_wav; }
+
+    private:
+        sykes::mapped_wav m_wav;
+        std::vector<float> m_head;
+        bool m_locked;
+
+        explicit Sample(std::string const& _path);
+        Sample(Sample const&);
+        Sample& operator=(Sample const&);
+    };
+
+    //-----------------------------------------------------------
+    //    class SampleStream
+    //        the ring one voice plays the part of a sample after its
+    //        head from. the audio thread asks for a sample with
+    //        Start and reads frames by their index past the head;
+    //        the prefetch thread sees the new request, notes where
+    //        in the ring it begins and fills it from the mapped file.
+    //        indices only grow, so a request never has to empty the
+    //        ring: the old frames are simply skipped.
+    //-----------------------------------------------------------
+    class SampleStream
+    {
+    public:
+        static std::size_t const capacity;
+
+        // _samples are every sample this stream may be asked for
+        explicit SampleStream(std::vector<std::shared_ptr<Sample const>> const& _samples);
+
+        // audio thread
+        void Start(std::size_t _sample);
+
+        // true once the prefetch thread has taken the last Start
+        inline bool Ready()
+        {
+            if(m_ready) return true;
+            if(m_ready_epoch.load(std::memory_order_acquire) != m_epoch) return false;
+            m_start = m_epoch_start.load(std::memory_order_relaxed);
+            m_read.store(m_start, std::memory_order_release);
+            m_ready = true;
+            // the frames of the last request are all freed at once
+            WakePrefetcher();
+            return true;
+        }
+
+        // frame _index past the head, false if it has not arrived
+        inline bool Get(std::size_t _index, float& _out) const
+        {
+            std::size_t const r = m_start + _index;
+            if(r >= m_write.load(std::memory_order_acquire)) return false;
+            _out = m_ring[r & (capacity - 1)];
+            return true;
+        }
+
+        // the frames before _index are no longer needed. the
+        // prefetch thread is woken each time a chunk is freed
+        inline void Release(std::size_t _index)
+        {
+            std::size_t const read = m_start + _index;
+            std::size_t const last = m_read.load(std::memory_order_relaxed);
+            m_read.store(read, std::memory_order_release);
+            if(read / Constants::sampler_chunk_frames != last / Constants::sampler_chunk_frames)
+                WakePrefetcher();
+        }
+
+        // prefetch thread
+        void Fill();
+
+        // frames the audio thread wanted before they arrived, over
+        // every stream
+        static std::uint64_t Underruns();
+        static void CountUnderrun();
+
+    private:
+        static void WakePrefetcher();
+
+        std::vector<std::shared_ptr<Sample const>> m_samples;
+        std::unique_ptr<float[]> m_ring;
+        std::atomic<std::size_t> m_write;
+        std::atomic<std::size_t> m_read;
+        // requests, audio thread to prefetch thread
+        std::atomic<std::size_t> m_request;
+        std::atomic<std::uint32_t> m_request_epoch;
+        // answers, prefetch thread to audio thread
+        std::atomic<std::size_t> m_epoch_start;
+        std::atomic<std::uint32_t> m_ready_epoch;
+        // audio thread
+        std::uint32_t m_epoch;
+        bool m_ready;
+        std::size_t m_start;
+        // prefetch thread
+        std::uint32_t m_fill_epoch;
+        std::size_t m_fill_sample;
+        std::size_t m_fill_position;
+
+        SampleStream(SampleStream const&);
+        SampleStream& operator=(SampleStream const&);
+    };
+
+    // hands _stream to the prefetch thread, which keeps filling it
+    // until it is the last owner. control thread
+    void RegisterSampleStream(std::shared_ptr<SampleStream> const& _stream);
+}//---- namespace
+
+#endif
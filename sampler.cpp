@@ -0,0 +1,163 @@
+//-----------------------------------------------------------
+//    sampler.cpp
+//-----------------------------------------------------------
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "sampler.h"
+
+namespace TSynth{
+    TSYNTH_DECLARE_NULLARY_MOD(SynthSampler, (sykes::nocast(), StoD()))
+
+    namespace{
+        // SynthSampler[<keymap>] next to SynthSampler[<path> <root>]
+        std::string const sampler_keymap_key =
+            SynthModFactory::RegisterMod("SynthSampler", AModFactory<NullaryMod<SynthSampler>>(),
+                std::make_tuple(sykes::nocast()));
+
+        ModParam const sampler_params[] = {
+            {"tune", &ModParamGet<SynthSampler, &SynthSampler::GetTune>,
+                &ModParamSet<SynthSampler, &SynthSampler::SetTune>, true}
+        };
+    }
+
+    ModParamList const SynthSampler::params = {sampler_params, sizeof(sampler_params) / sizeof(sampler_params[0])};
+
+    //-----------------------------------------------------------
+    //    paths in a keymap are relative to the keymap
+    //-----------------------------------------------------------
+    SynthSampler::SynthSampler(std::string const& _keymap)
+        : m_zones(), m_zone_of(), m_stream(),
+        m_tune(0.0), m_tune_ratio(1.0), m_last_val(),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_note(0), m_zone(0), m_head(0), m_frames(0),
+        m_position(0.0), m_step(0.0), m_playing(false)
+    {
+        std::ifstream in(_keymap.c_str());
+        if(!in) throw std::runtime_error("SynthSampler: cannot open " + _keymap);
+        std::string const dir = (_keymap.find('/') == std::string::npos)
+            ? std::string() : _keymap.substr(0, _keymap.rfind('/') + 1);
+
+        std::string line;
+        while(std::getline(in, line)){
+            std::istringstream is(line);
+            int root;
+            std::string path;
+            if(line.empty() || line[0] == '#') continue;
+            if(!(is >> root >> path) || root < 0 || root > 127)
+                throw std::runtime_error("SynthSampler: bad line in " + _keymap + ": " + line);
+            AddZone(static_cast<UInt8>(root), (path[0] == '/') ? path : dir + path);
+        }
+        MapZones();
+    }
+
+    SynthSampler::SynthSampler(std::string const& _path, Real _root)
+        : m_zones(), m_zone_of(), m_stream(),
+        m_tune(0.0), m_tune_ratio(1.0), m_last_val(),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_note(0), m_zone(0), m_head(0), m_frames(0),
+        m_position(0.0), m_step(0.0), m_playing(false)
+    {
+        if(_root < 0.0 || _root > 127.0)
+            throw std::runtime_error("SynthSampler: root note out of range");
+        AddZone(static_cast<UInt8>(_root + 0.5), _path);
+        MapZones();
+    }
+
+    //-----------------------------------------------------------
+    //    the samples are shared, the stream is not
+    //-----------------------------------------------------------
+    SynthSampler::SynthSampler(SynthSampler const& _other)
+        : m_zones(_other.m_zones), m_zone_of(_other.m_zone_of), m_stream(),
+        m_tune(_other.m_tune), m_tune_ratio(_other.m_tune_ratio), m_last_val(),
+        m_sample_rate(_other.m_sample_rate),
+        m_note(_other.m_note), m_zone(_other.m_zone), m_head(_other.m_head), m_frames(_other.m_frames),
+        m_position(0.0), m_step(_other.m_step), m_playing(false)
+    {
+        MapZones();
+    }
+
+    //-----------------------------------------------------------
+    //
+    //-----------------------------------------------------------
+    void SynthSampler::AddZone(UInt8 _root, std::string const& _path)
+    {
+        m_zones.push_back(Zone{_root, Sample::Load(_path)});
+    }
+
+    //-----------------------------------------------------------
+    //    every note plays the zone with the nearest root, the
+    //    lower one on a tie
+    //-----------------------------------------------------------
+    void SynthSampler::MapZones()
+    {
+        if(m_zones.empty()) throw std::runtime_error("SynthSampler: no samples");
+        for(std::size_t n = 0; n < m_zone_of.size(); ++n){
+            std::size_t best = 0;
+            for(std::size_t z = 1; z < m_zones.size(); ++z){
+                int const d = std::abs(int(m_zones[z].root) - int(n));
+                int const d_best = std::abs(int(m_zones[best].root) - int(n));
+                if(d < d_best || (d == d_best && m_zones[z].root < m_zones[best].root))
+                    best = z;
+            }
+            m_zone_of[n] = static_cast<UInt8>(best);
+        }
+
+        std::vector<std::shared_ptr<Sample const>> samples;
+        for(std::size_t z = 0; z < m_zones.size(); ++z)
+            samples.push_back(m_zones[z].sample);
+        m_stream = std::make_shared<SampleStream>(samples);
+        RegisterSampleStream(m_stream);
+        m_head = &m_zones[m_zone].sample->Head();
+        m_frames = m_zones[m_zone].sample->Frames();
+    }
+
+    //-----------------------------------------------------------
+    //
+    //-----------------------------------------------------------
+    void SynthSampler::NoteOn(UInt8 _note)
+    {
+        m_note = _note;
+        m_zone = m_zone_of[_note & 0x7F];
+        Sample const& sample = *m_zones[m_zone].sample;
+        m_head = &sample.Head();
+        m_frames = sample.Frames();
+        m_position = 0.0;
+        m_playing = (m_frames != 0);
+        if(m_frames > m_head->size()) m_stream->Start(m_zone);
+        UpdateStep();
+    }
+
+    //-----------------------------------------------------------
+    //
+    //-----------------------------------------------------------
+    void SynthSampler::UpdateStep()
+    {
+        Sample const& sample = *m_zones[m_zone].sample;
+        Real const pitch = sykes::midi::note_table[m_note] / sykes::midi::note_table[m_zones[m_zone].root];
+        m_step = pitch * m_tune_ratio * Real(sample.SampleRate()) / Real(m_sample_rate);
+    }
+
+    //-----------------------------------------------------------
+    //
+    //-----------------------------------------------------------
+    void SynthSampler::SetSampleRate(std::size_t _sr)
+    {
+        if(_sr == 0) return;
+        m_sample_rate = _sr;
+        UpdateStep();
+    }
+
+    //-----------------------------------------------------------
+    //
+    //-----------------------------------------------------------
+    void SynthSampler::SetTune(Real _semitones)
+    {
+        m_tune = _semitones;
+        m_tune_ratio = std::pow(2.0, _semitones / 12.0);
+        UpdateStep();
+    }
+}//---- namespace
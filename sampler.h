@@ -0,0 +1,141 @@
+//-----------------------------------------------------------
+//    SynthSampler
+//-----------------------------------------------------------
+#ifndef SYNTH_SAMPLER_H
+#define SYNTH_SAMPLER_H
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+#include "sample_store.h"
+
+namespace TSynth{
+    //-----------------------------------------------------------
+    //    class SynthSampler
+    //        plays the sample whose root note is nearest to the
+    //        note, once from the start, resampled to the pitch with
+    //        4 point hermite interpolation. the head comes from
+    //        memory, the rest from the SampleStream of this voice;
+    //        a frame that has not arrived yet holds the playback
+    //        and counts as an underrun.
+    //        every copy gets a stream of its own.
+    //-----------------------------------------------------------
+    class SynthSampler : MidiReceivable
+    {
+    public:
+        typedef Real result_type;
+        static std::uint8_t const midi_mask =
+            sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_ON);
+        static ModParamList const params;
+
+        // a keymap file, one "<root note> <wav path>" per line
+        explicit SynthSampler(std::string const& _keymap);
+        // one sample played at its pitch on _root
+        SynthSampler(std::string const& _path, Real _root);
+        SynthSampler(SynthSampler const& _other);
+
+        inline Real operator()()
+        {
+            if(!m_playing) return 0.0;
+            // taking the answer while still in the head gives the
+            // prefetch thread the whole head to fill the ring
+            if(m_frames > m_head->size()) m_stream->Ready();
+
+            std::size_t const i = static_cast<std::size_t>(m_position);
+            Real const t = m_position - Real(i);
+            std::array<Real, 4> x;
+            for(std::size_t k = 0; k < 4; ++k){
+                // frame i - 1 + k, clamped to the sample
+                std::size_t const f = (i + k == 0) ? 0 : i + k - 1;
+                if(f >= m_frames){
+                    x[k] = 0.0;
+                }else if(f < m_head->size()){
+                    x[k] = (*m_head)[f];
+                }else{
+                    float v;
+                    if(!m_stream->Ready() || !m_stream->Get(f - m_head->size(), v)){
+                        SampleStream::CountUnderrun();
+                        return m_last_val = 0.0;
+                    }
+                    x[k] = v;
+                }
+            }
+
+            Real const c1 = 0.5 * (x[2] - x[0]);
+            Real const c2 = x[0] - 2.5 * x[1] + 2.0 * x[2] - 0.5 * x[3];
+            Real const c3 = 0.5 * (x[3] - x[0]) + 1.5 * (x[1] - x[2]);
+            m_last_val = ((c3 * t + c2) * t + c1) * t + x[1];
+
+            m_position += m_step;
+            std::size_t const next = static_cast<std::size_t>(m_position);
+            if(next >= m_frames) m_playing = false;
+            else if(next > m_head->size()) m_stream->Release(next - 1 - m_head->size());
+            return m_last_val;
+        }
+
+        void SetSampleRate(std::size_t _sr);
+
+        // offset from the note in semitones
+        void SetTune(Real _semitones);
+
+        inline Real GetTune() const
+        { return m_tune; }
+
+        inline Real GetLastVal() const
+        { return m_last_val; }
+
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            switch(sykes::midi::message::type(_m))
+            {
+                case sykes::midi::channel_voice_message_type::NOTE_ON:
+                {
+                    UInt8 note = sykes::midi::message::data1(_m);
+                    if(note < sykes::midi::note_table_size)
+                        NoteOn(note);
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+    private:
+        struct Zone
+        {
+            UInt8 root;
+            std::shared_ptr<Sample const> sample;
+        };
+
+        void AddZone(UInt8 _root, std::string const& _path);
+        void MapZones();
+        void NoteOn(UInt8 _note);
+        void UpdateStep();
+
+        std::vector<Zone> m_zones;
+        // zone of every note
+        std::array<UInt8, 128> m_zone_of;
+        std::shared_ptr<SampleStream> m_stream;
+        Real m_tune;
+        Real m_tune_ratio;
+        Real m_last_val;
+        std::size_t m_sample_rate;
+        UInt8 m_note;
+        std::size_t m_zone;
+        std::vector<float> const* m_head;
+        std::size_t m_frames;
+        // in frames of the sample
+        Real m_position;
+        Real m_step;
+        bool m_playing;
+
+        SynthSampler& operator=(SynthSampler const&);
+
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
@@ -0,0 +1,73 @@
+//-----------------------------------------------------------
+//    shm_pcm_out.cpp
+//-----------------------------------------------------------
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <new>
+#include <algorithm>
+#include <stdexcept>
+#include "shm_pcm_out.h"
+
+namespace sykes{
+
+    shm_pcm_out::shm_pcm_out(std::string const& _name, std::size_t _sample_rate, std::size_t _buffer_size, double _speed)
+        :
+        clocked_pcm_out(_sample_rate, _buffer_size, _speed),
+        m_name((!_name.empty() && _name[0] == '/') ? _name : ("/" + _name)),
+        m_map_size(sizeof(shm_pcm_header)
+            + _buffer_size * default_ring_periods * m_channel_count * sizeof(buffer_format_type)),
+        m_header(0),
+        m_ring(0)
+    {
+        int const fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0600);
+        if(fd < 0) throw std::runtime_error("shm_pcm_out::shm_pcm_out() cannot open " + m_name);
+        if(ftruncate(fd, off_t(m_map_size)) != 0){
+            close(fd);
+            shm_unlink(m_name.c_str());
+            throw std::runtime_error("shm_pcm_out::shm_pcm_out() cannot resize " + m_name);
+        }
+        void* p = mmap(0, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if(p == MAP_FAILED){
+            shm_unlink(m_name.c_str());
+            throw std::runtime_error("shm_pcm_out::shm_pcm_out() cannot map " + m_name);
+        }
+
+        m_header = new(p) shm_pcm_header;
+        m_header->channels = std::uint32_t(m_channel_count);
+        m_header->sample_rate = std::uint32_t(_sample_rate);
+        m_header->capacity = std::uint32_t(_buffer_size * default_ring_periods);
+        m_header->write_frame.store(0, std::memory_order_relaxed);
+        m_ring = reinterpret_cast<buffer_format_type*>(static_cast<char*>(p) + sizeof(shm_pcm_header));
+        std::fill(m_ring, m_ring + m_header->capacity * m_channel_count, buffer_format_type(0));
+        // readers check the magic last
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = shm_pcm_header::magic_value;
+    }
+
+    shm_pcm_out::~shm_pcm_out()
+    {
+        stop();
+        munmap(m_header, m_map_size);
+        shm_unlink(m_name.c_str());
+    }
+
+    void shm_pcm_out::deliver(buffer_format_type const* _frames, std::size_t _frame_count)
+    {
+        std::uint64_t const write_frame = m_header->write_frame.load(std::memory_order_relaxed);
+        std::size_t const capacity = m_header->capacity;
+        std::size_t pos = std::size_t(write_frame % capacity);
+        std::size_t done = 0;
+        while(done < _frame_count){
+            std::size_t const n = std::min(_frame_count - done, capacity - pos);
+            std::copy(_frames + done * m_channel_count,
+                _frames + (done + n) * m_channel_count,
+                m_ring + pos * m_channel_count);
+            done += n;
+            pos = 0;
+        }
+        m_header->write_frame.store(write_frame + _frame_count, std::memory_order_release);
+    }
+}//----
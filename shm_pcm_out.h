@@ -0,0 +1,55 @@
+//-----------------------------------------------------------
+//    shm_pcm_out
+//-----------------------------------------------------------
+#ifndef SYKES_SHM_PCM_OUT_H
+#define SYKES_SHM_PCM_OUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include "clocked_pcm_out.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    shm_pcm_header
+    //        layout at the start of the shared memory object.
+    //        interleaved float frames follow the header; the writer
+    //        never waits for readers and publishes write_frame after
+    //        each period, readers take frames
+    //        [write_frame - capacity, write_frame) modulo capacity.
+    //-----------------------------------------------------------
+    struct shm_pcm_header
+    {
+        static std::uint32_t const magic_value = 0x43505354; // "TSPC"
+
+        std::uint32_t magic;
+        std::uint32_t channels;
+        std::uint32_t sample_rate;
+        std::uint32_t capacity;   // in frames
+        std::atomic<std::uint64_t> write_frame;
+    };
+
+    //-----------------------------------------------------------
+    //    class shm_pcm_out
+    //-----------------------------------------------------------
+    class shm_pcm_out
+        : public clocked_pcm_out
+    {
+    public:
+        static std::size_t const default_ring_periods = 16;
+
+        shm_pcm_out(std::string const& _name, std::size_t _sample_rate, std::size_t _buffer_size, double _speed = 1.0);
+        ~shm_pcm_out();
+
+    private:
+        std::string m_name;
+        std::size_t m_map_size;
+        shm_pcm_header* m_header;
+        buffer_format_type* m_ring;
+
+        void deliver(buffer_format_type const* _frames, std::size_t _frame_count);
+    };
+}//----
+#endif
@@ -0,0 +1,149 @@
+//-----------------------------------------------------------
+//    socket_midi_in.cpp
+//-----------------------------------------------------------
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include "socket_midi_in.h"
+
+namespace sykes{
+
+    socket_midi_in::socket_midi_in(unsigned short _port)
+        :
+        m_running(false),
+        m_socket(socket(AF_INET, SOCK_DGRAM, 0)),
+        m_path(),
+        m_datagram(max_datagram_size, 0),
+        m_on_midi_event(),
+        m_worker(),
+        m_mutex(),
+        m_running_mutex()
+    {
+        if(m_socket < 0) throw std::runtime_error("socket_midi_in::socket_midi_in() socket");
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(_port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0){
+            close(m_socket);
+            throw std::runtime_error("socket_midi_in::socket_midi_in() bind");
+        }
+    }
+
+    socket_midi_in::socket_midi_in(std::string const& _path)
+        :
+        m_running(false),
+        m_socket(socket(AF_UNIX, SOCK_DGRAM, 0)),
+        m_path(_path),
+        m_datagram(max_datagram_size, 0),
+        m_on_midi_event(),
+        m_worker(),
+        m_mutex(),
+        m_running_mutex()
+    {
+        if(m_socket < 0) throw std::runtime_error("socket_midi_in::socket_midi_in() socket");
+
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if(_path.size() >= sizeof(addr.sun_path)){
+            close(m_socket);
+            throw std::runtime_error("socket_midi_in::socket_midi_in() path too long");
+        }
+        std::strcpy(addr.sun_path, _path.c_str());
+        unlink(_path.c_str());
+        if(bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0){
+            close(m_socket);
+            throw std::runtime_error("socket_midi_in::socket_midi_in() bind " + _path);
+        }
+    }
+
+    socket_midi_in::~socket_midi_in()
+    {
+        stop();
+        close(m_socket);
+        if(!m_path.empty()) unlink(m_path.c_str());
+    }
+
+    void socket_midi_in::set_on_midi_event(handler_type const& _f)
+    {
+        lock_type lk(m_mutex);
+        m_on_midi_event = _f;
+    }
+
+    void socket_midi_in::start()
+    {
+        lock_type lk(m_mutex);
+        lock_type lk2(m_running_mutex);
+        if(m_running) return;
+
+        m_running = true;
+        m_worker = std::unique_ptr<thread_type>(new thread_type(&socket_midi_in::routine, this));
+    }
+
+    void socket_midi_in::stop()
+    {
+        {
+            lock_type lk(m_running_mutex);
+            if(!m_running) return;
+            m_running = false;
+        }
+        m_worker->join();
+    }
+
+    bool socket_midi_in::is_running() const
+    {
+        lock_type lk(m_running_mutex);
+        return m_running;
+    }
+
+    void socket_midi_in::routine()
+    {
+        pollfd pfd = {m_socket, POLLIN, 0};
+        while(1){
+            {
+                lock_type lk(m_running_mutex);
+                if(!m_running) break;
+            }
+            if(poll(&pfd, 1, poll_wait) > 0 && (pfd.revents & POLLIN)){
+                ssize_t const size = recv(m_socket, &m_datagram[0], m_datagram.size(), 0);
+                if(size > 0)
+                    dispatch(&m_datagram[0], std::size_t(size), boost::posix_time::microsec_clock::universal_time());
+            }
+        }
+    }
+
+    // splits the datagram into messages, running status is not supported
+    // and system exclusive is skipped up to its terminator.
+    void socket_midi_in::dispatch(std::uint8_t const* _bytes, std::size_t _size, ptime _t)
+    {
+        lock_type lk(m_mutex);
+        std::size_t i = 0;
+        while(i < _size){
+            std::uint8_t const stat = _bytes[i];
+            if(stat < 0x80){
+                ++i;
+                continue;
+            }
+            std::size_t const length = midi::message_length(stat);
+            if(length == 0){
+                while(i < _size && _bytes[i] != midi::SMT::END_OF_EXCLUSIVE) ++i;
+                ++i;
+                continue;
+            }
+            if(i + length > _size) break;
+
+            std::uint8_t data[3] = {stat, 0, 0};
+            for(std::size_t j = 1; j < length; ++j) data[j] = _bytes[i + j];
+            if(m_on_midi_event) m_on_midi_event(midi::make_message(data), _t);
+            i += length;
+        }
+    }
+}//----
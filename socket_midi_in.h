@@ -0,0 +1,59 @@
+//-----------------------------------------------------------
+//    socket_midi_in
+//-----------------------------------------------------------
+#ifndef SYKES_SOCKET_MIDI_IN_H
+#define SYKES_SOCKET_MIDI_IN_H
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "midi_in.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class socket_midi_in
+    //        receives raw midi bytes as datagrams, either over udp
+    //        on the loopback interface or on a unix domain socket.
+    //        a datagram may carry several complete messages.
+    //-----------------------------------------------------------
+    class socket_midi_in
+        : public midi_in
+    {
+    public:
+        static std::size_t const max_datagram_size = 1024;
+        static int const poll_wait = 1000;
+
+        // udp on 127.0.0.1:_port
+        explicit socket_midi_in(unsigned short _port);
+        // unix domain datagram socket bound to _path
+        explicit socket_midi_in(std::string const& _path);
+        ~socket_midi_in();
+
+        void start();
+        void stop();
+        bool is_running() const;
+        void set_on_midi_event(handler_type const& _f);
+
+    private:
+        typedef boost::recursive_mutex mutex_type;
+        typedef mutex_type::scoped_lock lock_type;
+        typedef boost::thread thread_type;
+
+        bool m_running;
+        int m_socket;
+        std::string m_path;
+        std::vector<std::uint8_t> m_datagram;
+        handler_type m_on_midi_event;
+        std::unique_ptr<thread_type> m_worker;
+        mutex_type mutable m_mutex;
+        mutex_type mutable m_running_mutex;
+
+        void routine();
+        void dispatch(std::uint8_t const* _bytes, std::size_t _size, ptime _t);
+    };
+}//----
+#endif
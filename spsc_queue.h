@@ -0,0 +1,67 @@
+//-----------------------------------------------------------
+//    spsc_queue
+//-----------------------------------------------------------
+#ifndef SYKES_SPSC_QUEUE_H
+#define SYKES_SPSC_QUEUE_H
+
+#include <cstddef>
+#include <atomic>
+#include <array>
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class spsc_queue
+    //        bounded lock-free queue for one producer thread and
+    //        one consumer thread. never allocates; push fails when
+    //        the queue is full. Capacity must be a power of two.
+    //-----------------------------------------------------------
+    template<typename Tp, std::size_t Capacity>
+    class spsc_queue
+    {
+        static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+            "sykes::spsc_queue capacity must be a power of two");
+    public:
+        typedef Tp value_type;
+        static std::size_t const capacity = Capacity;
+
+        spsc_queue()
+            : m_head(0), m_tail(0), m_items()
+        {}
+
+        // producer side
+        bool push(value_type const& _v)
+        {
+            std::size_t const tail = m_tail.load(std::memory_order_relaxed);
+            if(tail - m_head.load(std::memory_order_acquire) == Capacity) return false;
+            m_items[tail & (Capacity - 1)] = _v;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side
+        bool pop(value_type& _v)
+        {
+            std::size_t const head = m_head.load(std::memory_order_relaxed);
+            if(head == m_tail.load(std::memory_order_acquire)) return false;
+            _v = m_items[head & (Capacity - 1)];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<std::size_t> m_head;
+        std::atomic<std::size_t> m_tail;
+        std::array<value_type, Capacity> m_items;
+
+        spsc_queue(spsc_queue const&);
+        spsc_queue& operator=(spsc_queue const&);
+    };
+}//---- namespace
+
+#endif
@@ -0,0 +1,233 @@
+//-----------------------------------------------------------
+//    static patch
+//-----------------------------------------------------------
+#ifndef SYNTH_STATIC_PATCH_H
+#define SYNTH_STATIC_PATCH_H
+
+#include <cstddef>
+#include "type.h"
+#include "midi_utility.h"
+#include "vco.h"
+#include "vcf.h"
+#include "vca.h"
+#include "mixer.h"
+
+namespace TSynth{
+namespace StaticPatch{
+    //-----------------------------------------------------------
+    //    a fixed patch written as a type, e.g.
+    //
+    //        typedef VCA<VCF<Mix<VCO, VCO>>> Flagship;
+    //        StaticVoice<Flagship> voice(
+    //            MakeVCA(SynthVCA(0.5, 0.02, 0.08, 0.5, 0.2),
+    //            MakeVCF(SynthVCF(0.01, 0.6, 0.8, 0.2),
+    //            MakeMix(
+    //                MakeVCO(SynthVCO(WaveType::SAW, 0.05, 0.2, 0.3, 1.5)),
+    //                MakeVCO(SynthVCO(WaveType::SQU, 0.01, 0.2, 0.3, 1.5))))));
+    //
+    //    is the same voice as the string
+    //
+    //        (SynthVCA[0.5 0.02 0.08 0.5 0.2] (SynthVCF[0.01 0.6 0.8 0.2]
+    //            (Mixer SynthVCO[SAW 0.05 0.2 0.3 1.5] SynthVCO[SQU 0.01 0.2 0.3 1.5])))
+    //
+    //    every node holds its mod by value and calls its inputs
+    //    directly, so the render loop of a StaticVoice is inlined
+    //    as a whole, without std::function or virtual calls.
+    //    midi goes to the nodes in preorder like MonoSynth does.
+    //-----------------------------------------------------------
+
+    //-----------------------------------------------------------
+    //    VCO
+    //-----------------------------------------------------------
+    struct VCO
+    {
+        VCO() : mod() {}
+        explicit VCO(SynthVCO const& _mod) : mod(_mod) {}
+
+        inline Real operator()()
+        {
+            return mod();
+        }
+
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            mod.MidiReceive(_m);
+        }
+
+        SynthVCO mod;
+    };
+
+    //-----------------------------------------------------------
+    //    VCF
+    //-----------------------------------------------------------
+    template<typename In>
+    struct VCF
+    {
+        VCF() : mod(), in() {}
+        VCF(SynthVCF const& _mod, In const& _in) : mod(_mod), in(_in) {}
+
+        inline Real operator()()
+        {
+            return mod(in());
+        }
+
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            mod.MidiReceive(_m);
+            in.MidiReceive(_m);
+        }
+
+        SynthVCF mod;
+        In in;
+    };
+
+    //-----------------------------------------------------------
+    //    VCA
+    //-----------------------------------------------------------
+    template<typename In>
+    struct VCA
+    {
+        VCA() : mod(), in() {}
+        VCA(SynthVCA const& _mod, In const& _in) : mod(_mod), in(_in) {}
+
+        inline Real operator()()
+        {
+            return mod(in());
+        }
+
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            mod.MidiReceive(_m);
+            in.MidiReceive(_m);
+        }
+
+        inline bool IsActive() const
+        {
+            return mod.IsActive();
+        }
+
+        SynthVCA mod;
+        In in;
+    };
+
+    //-----------------------------------------------------------
+    //    Mix
+    //-----------------------------------------------------------
+    template<typename In1, typename In2>
+    struct Mix
+    {
+        Mix() : mod(), in1(), in2() {}
+        Mix(In1 const& _in1, In2 const& _in2) : mod(), in1(_in1), in2(_in2) {}
+
+        inline Real operator()()
+        {
+            return mod(in1(), in2());
+        }
+
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            in1.MidiReceive(_m);
+            in2.MidiReceive(_m);
+        }
+
+        Mixer mod;
+        In1 in1;
+        In2 in2;
+    };
+
+    //-----------------------------------------------------------
+    //    Make functions
+    //-----------------------------------------------------------
+    inline VCO MakeVCO(SynthVCO const& _mod)
+    { return VCO(_mod); }
+
+    template<typename In>
+    inline VCF<In> MakeVCF(SynthVCF const& _mod, In const& _in)
+    { return VCF<In>(_mod, _in); }
+
+    template<typename In>
+    inline VCA<In> MakeVCA(SynthVCA const& _mod, In const& _in)
+    { return VCA<In>(_mod, _in); }
+
+    template<typename In1, typename In2>
+    inline Mix<In1, In2> MakeMix(In1 const& _in1, In2 const& _in2)
+    { return Mix<In1, In2>(_in1, _in2); }
+
+    //-----------------------------------------------------------
+    //    WithRootVCA
+    //        a patch whose root is not a VCA gets the same VCA
+    //        MonoSynth::BindModsInTree puts on top.
+    //-----------------------------------------------------------
+    template<typename Patch>
+    struct WithRootVCA
+    {
+        typedef VCA<Patch> type;
+
+        static type Make(Patch const& _patch)
+        {
+            return type(SynthVCA(0.1, 0.02, 0.1, 0.4, 0.2), _patch);
+        }
+    };
+
+    template<typename In>
+    struct WithRootVCA<VCA<In>>
+    {
+        typedef VCA<In> type;
+
+        static type const& Make(type const& _patch)
+        {
+            return _patch;
+        }
+    };
+
+    //-----------------------------------------------------------
+    //    class StaticVoice
+    //-----------------------------------------------------------
+    template<typename Patch>
+    class StaticVoice
+    {
+    public:
+        typedef typename WithRootVCA<Patch>::type patch_type;
+
+        StaticVoice()
+            : m_patch(WithRootVCA<Patch>::Make(Patch()))
+        {}
+
+        explicit StaticVoice(Patch const& _patch)
+            : m_patch(WithRootVCA<Patch>::Make(_patch))
+        {}
+
+        inline Real operator()()
+        {
+            return m_patch();
+        }
+
+        inline void Render(Real* _out, std::size_t _n)
+        {
+            for(std::size_t i = 0; i < _n; ++i)
+                _out[i] = m_patch();
+        }
+
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            m_patch.MidiReceive(_m);
+        }
+
+        inline bool IsActive() const
+        {
+            return m_patch.IsActive();
+        }
+
+        inline patch_type& GetPatch()
+        { return m_patch; }
+
+        inline patch_type const& GetPatch() const
+        { return m_patch; }
+
+    private:
+        patch_type m_patch;
+    };
+}//---- namespace StaticPatch
+}//---- namespace
+
+#endif
@@ -2,129 +2,550 @@
 //    Synth
 //-----------------------------------------------------------
 
+#include <algorithm>
+#include <stdexcept>
 #include "synth.h"
+#include "rt_check.h"
 
 namespace TSynth{
-    Synth::Synth()
+    //-----------------------------------------------------------
+    //    Synth::VoiceSet
+    //-----------------------------------------------------------
+    struct Synth::VoiceSet
+    {
+        explicit VoiceSet(MonoSynth const& _prototype)
+            : voices(), params(_prototype), next_retired(0)
+        {}
+        
+        std::array<MonoSynth, max_poly> voices;
+        ParamTable params;
+        VoiceSet* next_retired;
+    };
+    
+    //-----------------------------------------------------------
+    //    Synth::Part
+    //-----------------------------------------------------------
+    struct Synth::Part
+    {
+        Part()
+            : latest(0), kernel(), optimized(), routes(),
+            pending(0), volume(1.0), reserved(0), max_voices(max_poly), active(0),
+            sources(),
+            current(0), fading(0), fade_position(0), fade_length(0), gain(1.0)
+        {
+            for(std::size_t r = 0; r < routes.size(); ++r)
+                routes[r].source = ModSource{ModSourceKind::NONE, 0};
+        }
+        
+        // control thread. latest is the last composed set.
+        VoiceSet* latest;
+        std::string kernel;
+        OptimizeResult optimized;
+        std::array<ModRoute, ParamTable::max_routes> routes;
+        
+        // control thread -> audio thread, active the other way
+        std::atomic<VoiceSet*> pending;
+        std::atomic<Real> volume;
+        std::atomic<std::size_t> reserved;
+        std::atomic<std::size_t> max_voices;
+        std::atomic<std::size_t> active;
+        
+        // written by the midi thread, read by the audio thread
+        ModSources sources;
+        
+        // audio thread
+        VoiceSet* current;
+        VoiceSet* fading;
+        std::size_t fade_position;
+        std::size_t fade_length;
+        Real gain;
+    };
+    
+    static_assert(Synth::max_poly <= RenderProfile::max_voices, "TSynth::Synth");
+    static_assert(Synth::max_poly <= ParamTable::max_voices, "TSynth::Synth");
+    static_assert(Synth::max_parts <= 16, "TSynth::Synth");
+    
+    Synth::Synth(std::unique_ptr<sykes::pcm_out> _pcm_out, std::unique_ptr<sykes::midi_in> _midi_in)
         :
-        m_buffer_size(Constants::default_buffer_size),
+        m_buffer_size(_pcm_out->buffer_size()),
         m_state(),
-        m_synth(),
         m_buffer(m_buffer_size * 2, 0.0),
-        m_pcm_out(SynthModBase::GetSampleRate(), m_buffer_size),
-        m_midi_in("TSynth"),
-        m_midi_event(),
-        m_mutex()
-    {
-        std::fill(m_state.begin(), m_state.end(), MonoState{false, 0, 0});
-        std::fill(m_midi_event.begin(), m_midi_event.end(), message{0});
-        m_pcm_out.set_callback(std::bind(&Synth::OnPcm, this));
-        m_midi_in.set_on_midi_event(std::bind(&Synth::OnMidiEvent, this,
+        m_voice_buffer(m_buffer_size, 0.0),
+        m_right_buffer(m_buffer_size, 0.0),
+        m_pcm_out(std::move(_pcm_out)),
+        m_midi_in(std::move(_midi_in)),
+        m_patch_cache(Constants::patch_cache_size),
+        m_parts(new Part[max_parts]),
+        m_midi_queue(),
+        m_midi_dropped(0),
+        m_notes_dropped(0),
+        m_profile(),
+        m_profile_interval(0),
+        m_profile_countdown(0),
+        m_retired(0),
+        m_crossfade_blocks(default_crossfade_blocks)
+    {
+        std::fill(m_state.begin(), m_state.end(), MonoState{false, 0, 0, 0});
+        m_pcm_out->set_callback(std::bind(&Synth::OnPcm, this));
+        m_midi_in->set_on_midi_event(std::bind(&Synth::OnMidiEvent, this,
             std::placeholders::_1, std::placeholders::_2));
     }
         
     Synth::~Synth()
     {
         Stop();
+        for(std::size_t p = 0; p < max_parts; ++p){
+            Part& part = m_parts[p];
+            delete part.pending.exchange(0);
+            delete part.current;
+            delete part.fading;
+        }
+        Reclaim();
     }
-        
-    void Synth::Compose(std::string const& _str)
+    
+    Synth::Part& Synth::GetPart(std::size_t _part) const
+    {
+        if(_part >= max_parts)
+            throw std::runtime_error("no such part");
+        return m_parts[_part];
+    }
+    
+    // everything expensive happens here on the calling thread, the audio
+    // thread only picks the finished set up at the start of a period.
+    void Synth::Compose(std::size_t _part, std::string const& _str)
     {
-        lock_type lk(m_mutex);
-        m_synth[0].ComposeMonoSynthFromString(_str);
-        for(std::size_t i = 1; i < max_poly; ++i){
-            m_synth[i] = m_synth.front().Clone();
+        Part& part = GetPart(_part);
+        PatchCache::PrototypePtr prototype = m_patch_cache.Get(_str);
+        if(!prototype) return;
+        part.kernel = (prototype->KernelName()) ? prototype->KernelName() : "";
+        part.optimized = prototype->Optimized();
+        std::unique_ptr<VoiceSet> next(new VoiceSet(*prototype));
+        for(std::size_t i = 0; i < max_poly; ++i){
+            next->voices[i] = prototype->Clone();
+            next->voices[i].SetVoice(_part * max_poly + i);
+        }
+        
+        for(std::size_t r = 0; r < part.routes.size(); ++r){
+            if(part.routes[r].source.kind != ModSourceKind::NONE)
+                next->params.Map(r, part.routes[r]);
         }
+        
+        Reclaim();
+        part.latest = next.get();
+        // a set still pending was never seen by the audio thread
+        delete part.pending.exchange(next.release(), std::memory_order_acq_rel);
+    }
+    
+    void Synth::SetCrossfade(std::size_t _blocks)
+    {
+        m_crossfade_blocks.store(_blocks, std::memory_order_relaxed);
     }
         
     void Synth::Start()
     {
-        m_pcm_out.start();
-        m_midi_in.start();
+        m_pcm_out->start();
+        m_midi_in->start();
     }
         
     void Synth::Stop()
     {
-        m_midi_in.stop();
-        m_pcm_out.stop();
+        m_midi_in->stop();
+        m_pcm_out->stop();
     }
             
+    sykes::pcm_statistics_snapshot Synth::OutputStatistics() const
+    {
+        return m_pcm_out->statistics();
+    }
+    
+    PatchCache const& Synth::GetPatchCache() const
+    {
+        return m_patch_cache;
+    }
+    
+    std::string const& Synth::VoiceKernel(std::size_t _part) const
+    {
+        return GetPart(_part).kernel;
+    }
+    
+    void Synth::SetOptimize(bool _optimize)
+    {
+        m_patch_cache.SetOptimize(_optimize);
+    }
+    
+    bool Synth::Optimize() const
+    {
+        return m_patch_cache.Optimize();
+    }
+    
+    OptimizeResult Synth::PatchNodes(std::size_t _part) const
+    {
+        return GetPart(_part).optimized;
+    }
+    
+    void Synth::SetProfileInterval(std::size_t _blocks)
+    {
+        m_profile.RequestReset();
+        m_profile_interval.store(_blocks, std::memory_order_relaxed);
+    }
+    
+    std::size_t Synth::ProfileInterval() const
+    {
+        return m_profile_interval.load(std::memory_order_relaxed);
+    }
+    
+    RenderProfile::Snapshot Synth::Profile() const
+    {
+        return m_profile.GetSnapshot();
+    }
+    
+    // the values reach the audio thread at its next block, also when
+    // the set is still pending
+    bool Synth::SetParameter(std::size_t _part, std::string const& _path, Real _value)
+    {
+        Part& part = GetPart(_part);
+        return part.latest && part.latest->params.Request(_path, _value);
+    }
+    
+    std::vector<std::pair<std::string, Real>> Synth::Parameters(std::size_t _part) const
+    {
+        Part const& part = GetPart(_part);
+        if(!part.latest) return std::vector<std::pair<std::string, Real>>();
+        return part.latest->params.Requested();
+    }
+    
+    void Synth::MapMod(std::size_t _part, ModRoute const& _route)
+    {
+        Part& part = GetPart(_part);
+        if(!part.latest || part.latest->params.Find(_route.path) == ParamTable::npos)
+            throw std::runtime_error("no such parameter: " + _route.path);
+        std::size_t free = part.routes.size();
+        for(std::size_t r = 0; r < part.routes.size(); ++r){
+            ModRoute const& route = part.routes[r];
+            if(route.source == _route.source && route.path == _route.path){
+                free = r;
+                break;
+            }
+            if(route.source.kind == ModSourceKind::NONE && free == part.routes.size())
+                free = r;
+        }
+        if(free == part.routes.size())
+            throw std::runtime_error("mod matrix is full");
+        part.routes[free] = _route;
+        part.latest->params.Map(free, _route);
+    }
+    
+    bool Synth::UnmapMod(std::size_t _part, ModSource const& _source, std::string const& _path)
+    {
+        Part& part = GetPart(_part);
+        for(std::size_t r = 0; r < part.routes.size(); ++r){
+            ModRoute& route = part.routes[r];
+            if(!(route.source == _source && route.path == _path)) continue;
+            route.source = ModSource{ModSourceKind::NONE, 0};
+            route.path.clear();
+            if(part.latest) part.latest->params.Unmap(r);
+            return true;
+        }
+        return false;
+    }
+    
+    std::vector<ModRoute> Synth::ModRoutes(std::size_t _part) const
+    {
+        Part const& part = GetPart(_part);
+        std::vector<ModRoute> tmp;
+        for(std::size_t r = 0; r < part.routes.size(); ++r){
+            if(part.routes[r].source.kind != ModSourceKind::NONE)
+                tmp.push_back(part.routes[r]);
+        }
+        return tmp;
+    }
+    
+    // voices already playing over a new maximum ring out, only new
+    // notes are held back
+    void Synth::SetPartVoices(std::size_t _part, std::size_t _reserved, std::size_t _max)
+    {
+        Part& part = GetPart(_part);
+        if(_reserved > _max || _max > max_poly)
+            throw std::runtime_error("reserved voices must not exceed the maximum");
+        std::size_t total = _reserved;
+        for(std::size_t p = 0; p < max_parts; ++p){
+            if(p != _part) total += m_parts[p].reserved.load(std::memory_order_relaxed);
+        }
+        if(total > max_poly)
+            throw std::runtime_error("reserved voices of all parts exceed the voice slots");
+        part.reserved.store(_reserved, std::memory_order_relaxed);
+        part.max_voices.store(_max, std::memory_order_relaxed);
+    }
+    
+    void Synth::SetPartVolume(std::size_t _part, Real _volume)
+    {
+        GetPart(_part).volume.store(_volume, std::memory_order_relaxed);
+    }
+    
+    Synth::PartInfo Synth::GetPartInfo(std::size_t _part) const
+    {
+        Part const& part = GetPart(_part);
+        return PartInfo{
+            part.latest != 0,
+            part.reserved.load(std::memory_order_relaxed),
+            part.max_voices.load(std::memory_order_relaxed),
+            part.active.load(std::memory_order_relaxed),
+            part.volume.load(std::memory_order_relaxed)};
+    }
+    
+    // audio thread
+    bool Synth::ProfileThisBlock()
+    {
+        std::size_t const interval = m_profile_interval.load(std::memory_order_relaxed);
+        if(interval == 0) return false;
+        if(m_profile_countdown == 0 || m_profile_countdown >= interval){
+            m_profile_countdown = interval - 1;
+            m_profile.BeginBlock();
+            return true;
+        }
+        --m_profile_countdown;
+        return false;
+    }
+    
+    // the voices of all parts are rendered in one pass over the slots.
+    // part volumes ramp over the block.
     void Synth::OnPcm()
     {
-        using namespace sykes::midi;
-        decltype(m_state) state_copy;
-        decltype(m_midi_event) midi_event_copy;
         {
-            lock_type lk_stat(m_state_mutex);
-            lock_type lk(m_midi_event_mutex);
-            state_copy = m_state;
-            midi_event_copy = m_midi_event;
-            std::fill(m_midi_event.begin(), m_midi_event.end(), message{0});
-        }
-        
-        lock_type lk(m_mutex);
-        std::fill(m_buffer.begin(), m_buffer.end(), 0.0);
-        for(std::size_t i = 0; i < max_poly; ++i){
-            if(midi_event_copy[i].data != 0){
-                m_synth[i].MidiReceive(midi_event_copy[i]);
+            // everything up to the hand-off to the device must not
+            // allocate, lock or block
+            sykes::rt_scope rt;
+            for(std::size_t p = 0; p < max_parts; ++p){
+                Part& part = m_parts[p];
+                SwapVoiceSet(part);
+                if(part.current) part.current->params.Update(&part.current->voices[0], max_poly);
+            }
+            DispatchMidiEvents();
+            
+            std::array<std::uint8_t, max_poly> notes;
+            for(std::size_t i = 0; i < max_poly; ++i)
+                notes[i] = m_state[i].note;
+            std::array<bool, max_parts> ramping;
+            std::array<Real, max_parts> gain_step;
+            for(std::size_t p = 0; p < max_parts; ++p){
+                Part& part = m_parts[p];
+                ramping[p] = false;
+                gain_step[p] = (part.volume.load(std::memory_order_relaxed) - part.gain) / Real(m_buffer_size);
+                if(!part.current) continue;
+                part.current->params.Modulate(part.sources, &part.current->voices[0],
+                    &notes[0], max_poly, m_buffer_size);
+                ramping[p] = part.current->params.Ramping();
             }
-            if(state_copy[i].active){
+            
+            std::fill(m_buffer.begin(), m_buffer.end(), 0.0);
+            for(std::size_t p = 0; p < max_parts; ++p)
+                RenderFading(m_parts[p]);
+            bool const profiled = ProfileThisBlock();
+            for(std::size_t i = 0; i < max_poly; ++i){
+                if(!m_state[i].active) continue;
+                std::size_t const p = m_state[i].part;
+                Part& part = m_parts[p];
+                ParamTable& params = part.current->params;
+                MonoSynth& voice = part.current->voices[i];
+                std::size_t const chunk = (ramping[p]) ? Constants::param_ramp_chunk : m_buffer_size;
+                for(std::size_t j = 0; j < m_buffer_size; j += chunk){
+                    std::size_t const n = std::min(chunk, m_buffer_size - j);
+                    if(ramping[p]) params.ApplyRamps(voice, i, j + n);
+                    RenderVoice(voice, &m_voice_buffer[j], n, profiled, i);
+                    if(voice.Right()) voice.Right()->Render(&m_right_buffer[j], n);
+                }
+                Real const* const right = (voice.Right()) ? &m_right_buffer[0] : &m_voice_buffer[0];
+                Real gain = part.gain;
                 for(std::size_t j = 0; j < m_buffer_size; ++j){
-                    double d = m_synth[i]();
-                    m_buffer[j * 2] += d;
-                    m_buffer[j * 2 + 1] += d;
+                    m_buffer[j * 2] += m_voice_buffer[j] * gain;
+                    m_buffer[j * 2 + 1] += right[j] * gain;
+                    gain += gain_step[p];
                 }
-                if(!m_synth[i].IsActive()){
-                    lock_type lk_state(m_state_mutex);
-                    m_state[i] = MonoState{false, 0, 0};
+                if(!voice.IsActive()){
+                    m_state[i] = MonoState{false, 0, 0, 0};
+                    part.active.store(part.active.load(std::memory_order_relaxed) - 1,
+                        std::memory_order_relaxed);
                 }
             }
+            for(std::size_t p = 0; p < max_parts; ++p){
+                Part& part = m_parts[p];
+                if(ramping[p]) part.current->params.AdvanceRamps(&part.current->voices[0], max_poly, m_buffer_size);
+                part.gain += gain_step[p] * Real(m_buffer_size);
+            }
         }
-        m_pcm_out.write_buffer(m_buffer);
+        m_pcm_out->write_buffer(m_buffer);
     }
     
-    void Synth::OnMidiEvent(sykes::midi::message _m, ptime _t)
+    void Synth::RenderVoice(MonoSynth& _voice, Real* _out, std::size_t _n, bool _profiled, std::size_t _index)
     {
-        using namespace sykes::midi;
-        std::uint8_t state = sykes::midi::message::status(_m);
-        std::uint8_t data1 = sykes::midi::message::data1(_m);
-        std::uint8_t data2 = sykes::midi::message::data2(_m);
+        if(_profiled)
+            _voice.RenderProfiled(_out, _n, m_profile, _index);
+        else
+            _voice.Render(_out, _n);
+    }
+    
+    // runs at the period boundary on the audio thread. the voices of the
+    // new set start idle; notes still held on the old set ring out on
+    // fading, and the slots are freed once the new voices report
+    // inactive after their first period.
+    void Synth::SwapVoiceSet(Part& _part)
+    {
+        VoiceSet* next = _part.pending.exchange(0, std::memory_order_acq_rel);
+        if(!next) return;
         
-        if(data2 == 0 && state == CVMT::NOTE_ON)
-            state = CVMT::NOTE_OFF;
+        if(_part.fading){
+            Retire(_part.fading);
+            _part.fading = 0;
+        }
+        std::size_t const blocks = m_crossfade_blocks.load(std::memory_order_relaxed);
+        if(_part.current && blocks != 0){
+            _part.fading = _part.current;
+            _part.fade_position = 0;
+            _part.fade_length = blocks * m_buffer_size;
+        }else if(_part.current){
+            Retire(_part.current);
+        }
+        _part.current = next;
+    }
+    
+    void Synth::RenderFading(Part& _part)
+    {
+        if(!_part.fading) return;
         
-        switch(state)
-        {
-            case CVMT::NOTE_ON:
-            {
-                lock_type lk_stat(m_state_mutex);
-                lock_type lk(m_midi_event_mutex);
-                for(std::size_t i = 0; i < max_poly; ++i){
-                    if(!m_state[i].active && m_midi_event[i].data == 0){
-                        m_state[i].active = true;
-                        m_state[i].note = data1;
-                        m_state[i].velocity = data2;
-                        m_midi_event[i] = _m;
-                        return;
-                    }
-                }
-                return;
+        Real const step = 1.0 / Real(_part.fade_length);
+        std::size_t const end = std::min(_part.fade_position + m_buffer_size, _part.fade_length);
+        for(std::size_t i = 0; i < max_poly; ++i){
+            MonoSynth& voice = _part.fading->voices[i];
+            if(!voice.IsActive()) continue;
+            std::size_t const n = end - _part.fade_position;
+            voice.Render(&m_voice_buffer[0], n);
+            if(voice.Right()) voice.Right()->Render(&m_right_buffer[0], n);
+            Real const* const right = (voice.Right()) ? &m_right_buffer[0] : &m_voice_buffer[0];
+            Real gain = 1.0 - step * Real(_part.fade_position);
+            for(std::size_t j = 0; j < n; ++j){
+                m_buffer[j * 2] += m_voice_buffer[j] * gain * _part.gain;
+                m_buffer[j * 2 + 1] += right[j] * gain * _part.gain;
+                gain -= step;
             }
-            case CVMT::NOTE_OFF:
+        }
+        
+        _part.fade_position = end;
+        if(_part.fade_position >= _part.fade_length){
+            Retire(_part.fading);
+            _part.fading = 0;
+        }
+    }
+    
+    // lock-free push, called from the audio thread
+    void Synth::Retire(VoiceSet* _set)
+    {
+        _set->next_retired = m_retired.load(std::memory_order_relaxed);
+        while(!m_retired.compare_exchange_weak(_set->next_retired, _set,
+            std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+    
+    // frees the retired sets away from the audio thread
+    void Synth::Reclaim()
+    {
+        VoiceSet* p = m_retired.exchange(0, std::memory_order_acquire);
+        while(p){
+            VoiceSet* next = p->next_retired;
+            delete p;
+            p = next;
+        }
+    }
+    
+    // a part below its reservation may take any free slot. above it,
+    // the slots the other parts are still owed stay free.
+    void Synth::NoteOn(std::uint8_t _part, message _m)
+    {
+        Part& part = m_parts[_part];
+        if(!part.current) return;
+        std::size_t const active = part.active.load(std::memory_order_relaxed);
+        
+        std::size_t free = 0;
+        std::size_t slot = max_poly;
+        for(std::size_t i = 0; i < max_poly; ++i){
+            if(m_state[i].active) continue;
+            if(free++ == 0) slot = i;
+        }
+        std::size_t owed = 0;
+        for(std::size_t p = 0; p < max_parts; ++p){
+            if(p == _part) continue;
+            std::size_t const reserved = m_parts[p].reserved.load(std::memory_order_relaxed);
+            std::size_t const used = m_parts[p].active.load(std::memory_order_relaxed);
+            if(used < reserved) owed += reserved - used;
+        }
+        bool const within_reservation = active < part.reserved.load(std::memory_order_relaxed);
+        if(slot == max_poly
+            || active >= part.max_voices.load(std::memory_order_relaxed)
+            || (!within_reservation && free <= owed)){
+            m_notes_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        
+        using namespace sykes::midi;
+        m_state[slot] = MonoState{true, _part, message::data1(_m), message::data2(_m)};
+        part.active.store(active + 1, std::memory_order_relaxed);
+        part.current->voices[slot].MidiReceive(_m);
+    }
+    
+    // runs on the audio thread before the voices render. a voice set
+    // that is still fading keeps the notes it had, new notes go to
+    // the current set of their part only.
+    void Synth::DispatchMidiEvents()
+    {
+        using namespace sykes::midi;
+        message m;
+        while(m_midi_queue.pop(m)){
+            std::uint8_t type = message::type(m);
+            std::uint8_t const part = message::channel(m);
+            std::uint8_t const data1 = message::data1(m);
+            std::uint8_t const data2 = message::data2(m);
+            
+            if(data2 == 0 && type == CVMT::NOTE_ON)
+                type = CVMT::NOTE_OFF;
+            
+            switch(type)
             {
-                lock_type lk_stat(m_state_mutex);
-                lock_type lk(m_midi_event_mutex);
-                for(std::size_t i = 0; i < max_poly; ++i){
-                    if(m_state[i].note == data1 || message::data1(m_midi_event[i]) == data1){
-                        m_midi_event[i] = make_message(state, data1, data2);
+                case CVMT::NOTE_ON:
+                    NoteOn(part, m);
+                    break;
+                case CVMT::NOTE_OFF:
+                {
+                    message const off = make_message(CVMT::NOTE_OFF | part, data1, data2);
+                    for(std::size_t i = 0; i < max_poly; ++i){
+                        if(m_state[i].active && m_state[i].part == part && m_state[i].note == data1)
+                            m_parts[part].current->voices[i].MidiReceive(off);
                     }
+                    break;
                 }
-                return;
+                default:
+                    break;
             }
-            default:
-                return;
         }
     }
+    
+    // midi thread. never blocks on the audio thread.
+    void Synth::OnMidiEvent(sykes::midi::message _m, ptime _t)
+    {
+        if(!sykes::midi::is_channel_message(_m)) return;
+        // controllers are coalesced per channel, only notes are queued
+        if(m_parts[sykes::midi::message::channel(_m)].sources.Receive(_m)) return;
+        if(!m_midi_queue.push(_m))
+            m_midi_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    std::size_t Synth::DroppedMidiEvents() const
+    {
+        return m_midi_dropped.load(std::memory_order_relaxed);
+    }
+    
+    std::size_t Synth::DroppedNotes() const
+    {
+        return m_notes_dropped.load(std::memory_order_relaxed);
+    }
 
 }
 
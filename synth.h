@@ -8,21 +8,30 @@
 #include <array>
 #include <vector>
 #include <string>
+#include <memory>
+#include <atomic>
 
-#include <boost/thread/mutex.hpp>
-#include <boost/thread/recursive_mutex.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "type.h"
 #include "constants.h"
 #include "mono_synth.h"
-#include "alsa/alsa_pcm_out.h"
-#include "alsa/alsa_midi_in.h"
+#include "patch_cache.h"
+#include "profile.h"
+#include "param_table.h"
+#include "pcm_out.h"
+#include "midi_in.h"
+#include "spsc_queue.h"
 
 namespace TSynth{
     
     //-----------------------------------------------------------
     //    class Synth
+    //        multi-timbral. part p plays midi channel p + 1 with its
+    //        own patch, parameters, mod matrix and volume. the parts
+    //        share one pool of max_poly voice slots that is rendered
+    //        in one pass; a part may hold at most its maximum and is
+    //        always left room for its reserved count.
     //-----------------------------------------------------------
     class Synth
     {
@@ -30,46 +39,130 @@ namespace TSynth{
         struct MonoState
         {
             bool active;
+            std::uint8_t part;
             std::uint8_t note;
             std::uint8_t velocity;
         };
         
+        //-----------------------------------------------------------
+        //    VoiceSet
+        //        a complete set of voices for one patch. built on the
+        //        control thread, handed to the audio thread through
+        //        Part::pending and handed back through m_retired.
+        //        voice i plays voice slot i.
+        //-----------------------------------------------------------
+        struct VoiceSet;
+        struct Part;
+        
     public:
         typedef float format_type;
         typedef boost::posix_time::ptime ptime;
         typedef sykes::midi::message message;
-        static std::size_t const max_poly = 16;
+        static std::size_t const max_poly = 32;
+        static std::size_t const max_parts = 16;
+        static std::size_t const default_crossfade_blocks = 2;
+        static std::size_t const midi_queue_size = 256;
         
-        Synth();
+        struct PartInfo
+        {
+            bool composed;
+            std::size_t reserved;
+            std::size_t max_voices;
+            std::size_t active;
+            Real volume;
+        };
+        
+        Synth(std::unique_ptr<sykes::pcm_out> _pcm_out, std::unique_ptr<sykes::midi_in> _midi_in);
         ~Synth();
-        void Compose(std::string const& _str);
+        void Compose(std::size_t _part, std::string const& _str);
+        // frees the voice sets the audio thread has let go of. called
+        // by Compose and, so they do not wait for the next patch, from
+        // the control loop
+        void Reclaim();
+        void SetCrossfade(std::size_t _blocks);
         void Start();
         void Stop();
+        sykes::pcm_statistics_snapshot OutputStatistics() const;
+        PatchCache const& GetPatchCache() const;
+        // fused kernel of the last patch composed for _part, empty for
+        // the generic graph
+        std::string const& VoiceKernel(std::size_t _part) const;
+        // OptimizePatch for the patches composed from now on
+        void SetOptimize(bool _optimize);
+        bool Optimize() const;
+        // nodes of the last patch composed for _part, as written and
+        // as played
+        OptimizeResult PatchNodes(std::size_t _part) const;
+        // midi messages lost because the audio thread fell behind
+        std::size_t DroppedMidiEvents() const;
+        // note ons dropped because the part was at its maximum or no
+        // slot was left outside the other parts' reservations
+        std::size_t DroppedNotes() const;
+        // time every node of the voices in one block out of _blocks,
+        // 0 stops profiling. starts a new profile.
+        void SetProfileInterval(std::size_t _blocks);
+        std::size_t ProfileInterval() const;
+        RenderProfile::Snapshot Profile() const;
+        // live parameters of the last patch composed for _part, see
+        // ParamTable. false if the patch has no such parameter
+        bool SetParameter(std::size_t _part, std::string const& _path, Real _value);
+        std::vector<std::pair<std::string, Real>> Parameters(std::size_t _part) const;
+        // mod matrix of _part, fed by the controllers of its channel.
+        // a route for the same source and parameter is replaced. routes
+        // stay across compose and act on every patch that has their
+        // parameter. MapMod throws std::runtime_error when the matrix
+        // is full or the last patch lacks the parameter.
+        void MapMod(std::size_t _part, ModRoute const& _route);
+        bool UnmapMod(std::size_t _part, ModSource const& _source, std::string const& _path);
+        std::vector<ModRoute> ModRoutes(std::size_t _part) const;
+        // voice slots of _part. throws std::runtime_error when _reserved
+        // is over _max or the reservations of all parts exceed max_poly
+        void SetPartVoices(std::size_t _part, std::size_t _reserved, std::size_t _max);
+        void SetPartVolume(std::size_t _part, Real _volume);
+        PartInfo GetPartInfo(std::size_t _part) const;
         
     private:
-        typedef sykes::alsa_pcm_out pcm_out_type;
-        typedef sykes::alsa_midi_in midi_in_type;
-        typedef boost::recursive_mutex mutex_type;
-        typedef mutex_type::scoped_lock lock_type;
+        typedef sykes::pcm_out pcm_out_type;
+        typedef sykes::midi_in midi_in_type;
         std::size_t m_buffer_size;
         std::array<MonoState, max_poly> m_state;
-        std::array<MonoSynth, max_poly> m_synth;
         std::vector<format_type> m_buffer; 
-        pcm_out_type m_pcm_out;
-        midi_in_type m_midi_in;
-        std::array<sykes::midi::message, max_poly> m_midi_event;
-        mutex_type m_mutex;
-        mutex_type m_state_mutex;
-        mutex_type m_midi_event_mutex;
+        std::vector<Real> m_voice_buffer;
+        // the right channel of a voice with MonoSynth::Right()
+        std::vector<Real> m_right_buffer;
+        std::unique_ptr<pcm_out_type> m_pcm_out;
+        std::unique_ptr<midi_in_type> m_midi_in;
+        PatchCache m_patch_cache;
+        std::unique_ptr<Part[]> m_parts;
+        
+        // midi thread -> audio thread. voices are assigned on the
+        // audio thread, m_state belongs to it.
+        sykes::spsc_queue<sykes::midi::message, midi_queue_size> m_midi_queue;
+        std::atomic<std::size_t> m_midi_dropped;
+        std::atomic<std::size_t> m_notes_dropped;
+        
+        RenderProfile m_profile;
+        std::atomic<std::size_t> m_profile_interval;
+        std::size_t m_profile_countdown;
+        
+        std::atomic<VoiceSet*> m_retired;
+        std::atomic<std::size_t> m_crossfade_blocks;
         
         // private member functions
         void OnPcm();
         
+        void SwapVoiceSet(Part& _part);
+        void RenderFading(Part& _part);
+        void Retire(VoiceSet* _set);
+        Part& GetPart(std::size_t _part) const;
+        
+        void DispatchMidiEvents();
+        void NoteOn(std::uint8_t _part, message _m);
+        bool ProfileThisBlock();
+        void RenderVoice(MonoSynth& _voice, Real* _out, std::size_t _n, bool _profiled, std::size_t _index);
         void OnMidiEvent(sykes::midi::message _m, ptime _t);
     };
 
 }
 
 #endif
-
-
@@ -7,12 +7,17 @@
 #include "type.h"
 #include "midi_utility.h"
 #include "constants.h"
-#include "tree.h"
+#include "flat_tree.h"
+#include "arena.h"
 
 #include <string>
+#include <vector>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <functional>
 #include <type_traits>
+#include <typeinfo>
 
 #include <iostream>
 
@@ -22,11 +27,37 @@ namespace TSynth{
     class SynthVCA;
     
     typedef std::shared_ptr<SynthModBase> SynthModBasePtr;
-    typedef creek::tree<std::function<Real(void)>>::const_child_iterator TreeFunctionIterator;
+    // mods and tree nodes of one voice share an arena
+    typedef creek::arena_allocator<SynthModBasePtr> ModAllocator;
+    typedef creek::flat_tree<SynthModBasePtr, ModAllocator> ModTree;
+    typedef creek::flat_tree<std::function<Real(void)>> FunctionTree;
+    typedef FunctionTree::const_child_iterator TreeFunctionIterator;
     
     inline Real __Zero()
     { return 0.0; }
     
+    //-----------------------------------------------------------
+    //    MidiRoute
+    //        direct call into the MidiReceive of a wrapped mod,
+    //        collected per message kind when a voice is bound.
+    //-----------------------------------------------------------
+    struct MidiRoute
+    {
+        void* object;
+        void (*receive)(void*, sykes::midi::message);
+        
+        inline void operator()(sykes::midi::message _m) const
+        {
+            receive(object, _m);
+        }
+    };
+    
+    template<typename ModT>
+    inline void MidiRouteThunk(void* _mod, sykes::midi::message _m)
+    {
+        static_cast<ModT*>(_mod)->MidiReceive(_m);
+    }
+    
     //-----------------------------------------------------------
     //    class SynthModBase
     //-----------------------------------------------------------
@@ -50,7 +81,12 @@ namespace TSynth{
         
         inline SynthModBasePtr Clone() const
         {
-            return SynthModBasePtr(m_NewAsBase());
+            return m_Clone(ModAllocator());
+        }
+        
+        inline SynthModBasePtr Clone(ModAllocator const& _alloc) const
+        {
+            return m_Clone(_alloc);
         }
         
         inline explicit SynthModBase(SynthModType _t)
@@ -67,16 +103,69 @@ namespace TSynth{
             return m_IsActive();
         }
         
+        // message kinds the mod handles, 0 if it ignores midi
+        inline std::uint8_t MidiMask() const
+        {
+            return m_MidiMask();
+        }
+        
+        inline MidiRoute GetMidiRoute()
+        {
+            return m_GetMidiRoute();
+        }
+        
+        // the wrapped mod if it is a ModT, 0 otherwise
+        template<typename ModT>
+        inline ModT* As()
+        {
+            return (m_ModType() == typeid(ModT)) ? static_cast<ModT*>(m_ModPointer()) : 0;
+        }
+        
+        template<typename ModT>
+        inline ModT const* As() const
+        {
+            return const_cast<SynthModBase*>(this)->As<ModT>();
+        }
+        
         std::string const& Name() const
         {
             return m_Name();
         }
         
+        // parameters that can be changed while the patch plays
+        inline ModParamList Params() const
+        {
+            return m_Params();
+        }
+        
+        inline Real GetParam(std::size_t _i) const
+        {
+            return m_Params().params[_i].get(const_cast<SynthModBase*>(this)->m_ModPointer());
+        }
+        
+        inline void SetParam(std::size_t _i, Real _v)
+        {
+            m_Params().params[_i].set(m_ModPointer(), _v);
+        }
+        
         inline std::function<Real(void)>
         MakeFunction(TreeFunctionIterator _it, TreeFunctionIterator _end)
         {
             return m_MakeFunction(_it, _end);
         }
+        
+        // rate the mod is called at, GetSampleRate() unless it is
+        // under an Oversample
+        inline void SetModSampleRate(std::size_t _sr)
+        {
+            m_SetModSampleRate(_sr);
+        }
+        
+        // the voice the mod plays in, see VoiceOf
+        inline void SetModVoice(std::size_t _voice)
+        {
+            m_SetModVoice(_voice);
+        }
     private:
         SynthModType const m_type;
         
@@ -85,13 +174,25 @@ namespace TSynth{
         {
             static std::size_t value;
         };
-        virtual SynthModBase* m_NewAsBase() const = 0;
+        virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const = 0;
         inline virtual void m_MidiReceive(sykes::midi::message _message){}
         virtual std::function<Real(void)>
         m_MakeFunction(TreeFunctionIterator _it, TreeFunctionIterator _end) = 0;
         virtual std::string const& m_Name() const = 0;
         virtual bool m_IsActive() const
         { return true; }
+        virtual std::uint8_t m_MidiMask() const
+        { return 0; }
+        virtual MidiRoute m_GetMidiRoute()
+        { return MidiRoute{0, 0}; }
+        virtual std::type_info const& m_ModType() const = 0;
+        virtual void* m_ModPointer() = 0;
+        virtual ModParamList m_Params() const
+        { return ModParamList{0, 0}; }
+        virtual void m_SetModSampleRate(std::size_t _sr)
+        {}
+        virtual void m_SetModVoice(std::size_t _voice)
+        {}
     };
     
     template<bool B>
@@ -123,9 +224,34 @@ namespace TSynth{
             return std::ref(m_mod);
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<NullaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
         {
-            return new NullaryMod(*this);
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual std::string const& m_Name() const
@@ -158,9 +284,34 @@ namespace TSynth{
             return std::ref(m_mod);
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<NullaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
         {
-            return new NullaryMod(*this);
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual void m_MidiReceive(sykes::midi::message _message)
@@ -168,6 +319,16 @@ namespace TSynth{
             m_mod.MidiReceive(_message);
         }
         
+        inline virtual std::uint8_t m_MidiMask() const
+        {
+            return MidiMaskOf<ModT>::value;
+        }
+        
+        inline virtual MidiRoute m_GetMidiRoute()
+        {
+            return MidiRoute{&m_mod, &MidiRouteThunk<ModT>};
+        }
+        
         inline virtual std::string const& m_Name() const
         {
             return m_mod.ModName();
@@ -200,9 +361,34 @@ namespace TSynth{
             return std::bind(&ModT::operator(), std::ref(m_mod), std::bind(*_it));
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<UnaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
         {
-            return new UnaryMod(*this);
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual std::string const& m_Name() const
@@ -239,9 +425,34 @@ namespace TSynth{
             return std::bind(&ModT::operator(), std::ref(m_mod), std::bind(*_it));
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<UnaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
         {
-            return new UnaryMod(*this);
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual void m_MidiReceive(sykes::midi::message _message)
@@ -249,6 +460,16 @@ namespace TSynth{
             m_mod.MidiReceive(_message);
         }
         
+        inline virtual std::uint8_t m_MidiMask() const
+        {
+            return MidiMaskOf<ModT>::value;
+        }
+        
+        inline virtual MidiRoute m_GetMidiRoute()
+        {
+            return MidiRoute{&m_mod, &MidiRouteThunk<ModT>};
+        }
+        
         inline virtual std::string const& m_Name() const
         {
             return m_mod.ModName();
@@ -280,9 +501,34 @@ namespace TSynth{
             return std::bind(&ModT::operator(), std::ref(m_mod), std::bind(*_it));
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<UnaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
         {
-            return new UnaryMod(*this);
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual void m_MidiReceive(sykes::midi::message _message)
@@ -290,6 +536,16 @@ namespace TSynth{
             m_mod.MidiReceive(_message);
         }
         
+        inline virtual std::uint8_t m_MidiMask() const
+        {
+            return MidiMaskOf<ModT>::value;
+        }
+        
+        inline virtual MidiRoute m_GetMidiRoute()
+        {
+            return MidiRoute{&m_mod, &MidiRouteThunk<ModT>};
+        }
+        
         inline virtual std::string const& m_Name() const
         {
             return m_mod.ModName();
@@ -343,9 +599,34 @@ namespace TSynth{
             return tmp;
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<BinaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
         {
-            return new BinaryMod(*this);
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual std::string const& m_Name() const
@@ -396,9 +677,34 @@ namespace TSynth{
             return tmp;
         }
         
-        inline virtual SynthModBase* m_NewAsBase() const
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
         {
-            return new BinaryMod(*this);
+            return std::allocate_shared<BinaryMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
         }
         
         inline virtual void m_MidiReceive(sykes::midi::message _message)
@@ -406,7 +712,174 @@ namespace TSynth{
             m_mod.MidiReceive(_message);
         }
         
-        inline virtual void m_Name() const
+        inline virtual std::uint8_t m_MidiMask() const
+        {
+            return MidiMaskOf<ModT>::value;
+        }
+        
+        inline virtual MidiRoute m_GetMidiRoute()
+        {
+            return MidiRoute{&m_mod, &MidiRouteThunk<ModT>};
+        }
+        
+        inline virtual std::string const& m_Name() const
+        {
+            return m_mod.ModName();
+        }
+    };
+    
+    //-----------------------------------------------------------
+    //    MixFunction, class MixMod
+    //        mod with any number of inputs, taken all at once.
+    //        every sample the inputs are run into one buffer, padded
+    //        with zeros to a whole number of Constants::mixer_lanes,
+    //        and handed over in one call.
+    //        ModT::Mix(Real const*, std::size_t).
+    //-----------------------------------------------------------
+    template<typename ModT>
+    class MixFunction
+    {
+    public:
+        MixFunction(ModT* _mod, TreeFunctionIterator _it, TreeFunctionIterator _end)
+            : m_mod(_mod), m_inputs(_it, _end), m_values()
+        {
+            std::size_t const lanes = Constants::mixer_lanes;
+            m_values.assign((m_inputs.size() + lanes - 1) / lanes * lanes, 0.0);
+        }
+        
+        inline Real operator()() const
+        {
+            for(std::size_t i = 0, n = m_inputs.size(); i < n; ++i)
+                m_values[i] = m_inputs[i]();
+            return m_mod->Mix(m_values.data(), m_values.size());
+        }
+        
+    private:
+        ModT* m_mod;
+        std::vector<std::function<Real(void)>> m_inputs;
+        mutable std::vector<Real> m_values;
+    };
+    
+    template<typename ModT>
+    class MixMod : public SynthModBase
+    {
+    public:
+        MixMod()
+            : SynthModBase(SynthModType::BINARY), m_mod()
+        {}
+        
+        template<typename ... Ts>
+        MixMod(Ts ... args)
+            : SynthModBase(SynthModType::BINARY), m_mod(args...)
+        {}
+        
+    private:
+        ModT m_mod;
+        
+        inline virtual std::function<Real(void)>
+        m_MakeFunction(TreeFunctionIterator _it, TreeFunctionIterator _end)
+        {
+            if(std::size_t(std::distance(_it, _end)) > ModT::max_inputs)
+                throw std::runtime_error(m_mod.ModName() + " has too many inputs");
+            return MixFunction<ModT>(&m_mod, _it, _end);
+        }
+        
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<MixMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
+        }
+        
+        inline virtual std::string const& m_Name() const
+        {
+            return m_mod.ModName();
+        }
+    };
+    
+    //-----------------------------------------------------------
+    //    class PullMod
+    //        unary mod that gets its input as a function and calls
+    //        it itself, as often as it needs per sample.
+    //        ModT::operator()(std::function<Real(void)> const&).
+    //-----------------------------------------------------------
+    template<typename ModT>
+    class PullMod : public SynthModBase
+    {
+    public:
+        PullMod()
+            : SynthModBase(SynthModType::UNARY), m_mod()
+        {}
+        
+        template<typename ... Ts>
+        PullMod(Ts ... args)
+            : SynthModBase(SynthModType::UNARY), m_mod(args...)
+        {}
+        
+    private:
+        ModT m_mod;
+        
+        inline virtual std::function<Real(void)>
+        m_MakeFunction(TreeFunctionIterator _it, TreeFunctionIterator _end)
+        {
+            assert(_it != _end);
+            return std::bind(&ModT::operator(), std::ref(m_mod), *_it);
+        }
+        
+        inline virtual SynthModBasePtr m_Clone(ModAllocator const& _alloc) const
+        {
+            return std::allocate_shared<PullMod>(_alloc, *this);
+        }
+        
+        inline virtual std::type_info const& m_ModType() const
+        {
+            return typeid(ModT);
+        }
+        
+        inline virtual void* m_ModPointer()
+        {
+            return &m_mod;
+        }
+        
+        inline virtual ModParamList m_Params() const
+        {
+            return ModParamsOf<ModT>::Get();
+        }
+        
+        inline virtual void m_SetModSampleRate(std::size_t _sr)
+        {
+            SampleRateOf<ModT>::Set(m_mod, _sr);
+        }
+        
+        inline virtual void m_SetModVoice(std::size_t _voice)
+        {
+            VoiceOf<ModT>::Set(m_mod, _voice);
+        }
+        
+        inline virtual std::string const& m_Name() const
         {
             return m_mod.ModName();
         }
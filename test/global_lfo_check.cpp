@@ -0,0 +1,101 @@
+//-----------------------------------------------------------
+//    global_lfo_check.cpp
+//        plays one note on two voices of a patch whose ports read
+//        a GLOBAL SynthLFO, moving the lfos through a ParamTable
+//        as the Synth does, and fails unless both voices sound
+//        the same, sample for sample
+//-----------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "type.h"
+#include "midi_utility.h"
+#include "mono_synth.h"
+#include "mod_matrix.h"
+#include "param_table.h"
+
+namespace{
+    using namespace TSynth;
+
+    std::size_t const voices = 2;
+    std::size_t const block = 256;
+    // about two seconds
+    std::size_t const frames = 344 * block;
+
+    // one note on every voice, held for most of the render, then
+    // released. the voices are rendered one after the other
+    std::vector<Real> Render(std::string const& _patch)
+    {
+        MonoSynth prototype;
+        if(!prototype.ComposeMonoSynthFromString(_patch))
+            throw std::runtime_error("compose failed");
+        ParamTable params(prototype);
+        ModSources const sources;
+        std::vector<MonoSynth> synths(voices);
+        std::uint8_t notes[voices];
+        for(std::size_t i = 0; i < voices; ++i){
+            synths[i] = prototype.Clone();
+            synths[i].SetVoice(i);
+            notes[i] = 57;
+        }
+
+        std::vector<Real> out(frames * voices, 0.0);
+        for(std::size_t i = 0; i < voices; ++i)
+            synths[i].MidiReceive(sykes::midi::make_message(0x90, 57, 100));
+        for(std::size_t j = 0; j < frames; j += block){
+            if(j == frames * 3 / 4){
+                for(std::size_t i = 0; i < voices; ++i)
+                    synths[i].MidiReceive(sykes::midi::make_message(0x80, 57, 0));
+            }
+            params.Update(&synths[0], voices);
+            params.Modulate(sources, &synths[0], notes, voices, block);
+            for(std::size_t i = 0; i < voices; ++i)
+                synths[i].Render(&out[i * frames + j], block);
+        }
+        return out;
+    }
+
+    bool Check(std::string const& _patch)
+    {
+        std::vector<Real> const out = Render(_patch);
+        Real diff = 0.0;
+        Real peak = 0.0;
+        for(std::size_t j = 0; j < frames; ++j){
+            peak = std::max(peak, std::fabs(out[j]));
+            for(std::size_t i = 1; i < voices; ++i)
+                diff = std::max(diff, std::fabs(out[i * frames + j] - out[j]));
+        }
+        bool const ok = (diff == 0.0 && peak != 0.0);
+        std::cout << (ok ? "ok   " : "FAIL ") << _patch
+            << " (peak " << peak << ", diff " << diff << ")" << std::endl;
+        return ok;
+    }
+}
+
+int main()
+{
+    char const* const patches[] = {
+        // a port
+        "(SynthVCA[0.5 0.01 0.1 1.0 0.1] (SynthVCO[SIN 0 0 1 0.1] tune*12:SynthLFO[SQU 3 GLOBAL]))",
+        // a port and a $name of the same lfo
+        "(SynthVCA[0.5 0.01 0.1 1.0 0.1] (SynthVCF[0.01 0.6 0.8 0.2] cutoff*1.5:v=SynthLFO[TRI 2 GLOBAL] "
+            "(Mixer SynthVCO[SAW 0 0 1 0.1] (SynthVCO[SQU 0 0 1 0.1] tune*0.5:$v))))"
+    };
+
+    bool ok = true;
+    for(std::size_t i = 0; i < sizeof(patches) / sizeof(patches[0]); ++i){
+        try{
+            ok = Check(patches[i]) && ok;
+        }catch(std::exception const& _e){
+            std::cout << "FAIL " << patches[i] << " (" << _e.what() << ")" << std::endl;
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------
+//    optimize_check.cpp
+//        renders patches with and without OptimizePatch and
+//        fails unless both sound the same, sample for sample
+//-----------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "type.h"
+#include "midi_utility.h"
+#include "mono_synth.h"
+
+namespace{
+    using namespace TSynth;
+
+    std::size_t const block = 256;
+    // about two seconds
+    std::size_t const frames = 344 * block;
+
+    // one note held for most of the render, then released
+    std::vector<Real> Render(std::string const& _patch, bool _optimize)
+    {
+        MonoSynth synth;
+        if(!synth.ComposeMonoSynthFromString(_patch, _optimize))
+            throw std::runtime_error("compose failed");
+        synth.SetVoice(0);
+
+        std::vector<Real> out(frames, 0.0);
+        synth.MidiReceive(sykes::midi::make_message(0x90, 57, 100));
+        for(std::size_t i = 0; i < frames; i += block){
+            if(i == frames * 3 / 4) synth.MidiReceive(sykes::midi::make_message(0x80, 57, 0));
+            synth.Render(&out[i], block);
+        }
+        return out;
+    }
+
+    bool Check(std::string const& _patch)
+    {
+        std::vector<Real> const on = Render(_patch, true);
+        std::vector<Real> const off = Render(_patch, false);
+        Real diff = 0.0;
+        Real peak = 0.0;
+        for(std::size_t i = 0; i < frames; ++i){
+            diff = std::max(diff, std::fabs(on[i] - off[i]));
+            peak = std::max(peak, std::fabs(off[i]));
+        }
+        bool const ok = (diff == 0.0 && peak != 0.0);
+        std::cout << (ok ? "ok   " : "FAIL ") << _patch
+            << " (peak " << peak << ", diff " << diff << ")" << std::endl;
+        return ok;
+    }
+}
+
+int main()
+{
+    char const* const patches[] = {
+        // plain mixers, merged, pruned and sorted
+        "(SynthVCA[0.5 0.01 0.1 0.5 0.2] (Mixer[1,0.5] (Mixer SynthVCO[SQU 0 0 1 0.1] SynthVCO[SAW 0 0 1 0.1]) "
+            "SynthVCO[SIN 0 0 1 0.1]))",
+        "(SynthVCA[0.5 0.01 0.1 0.5 0.2] (Mixer[1,0] SynthVCO[SAW 0 0 1 0.1] SynthVCO[SQU 0 0 1 0.1]))",
+        // the order of the nodes run ahead decides what a $name reads
+        "(SynthVCA[0.5 0.01 0.1 0.5 0.2] (Mixer a=SynthVCO[SAW 0.05 0.2 0.3 1.5] "
+            "(x=SynthVCF[0.01 0.6 0.8 0.2] $a) $x))",
+        "(SynthVCA[0.5 0.01 0.1 0.5 0.2] (Mixer (x=SynthVCF[0.01 0.6 0.8 0.2] SynthVCO[SQU 0 0 1 0.1]) "
+            "SynthVCO[SAW 0 0 1 0.1] $x))",
+        // a port under a mixer that is merged into its parent
+        "(SynthVCA[0.5 0.01 0.1 0.5 0.2] (Mixer (Mixer (SynthVCO[SAW 0 0 1 0.1] tune*0.5:SynthLFO[SIN 5 KEY]) "
+            "SynthVCO[SQU 0 0 1 0.1])))"
+    };
+
+    bool ok = true;
+    for(std::size_t i = 0; i < sizeof(patches) / sizeof(patches[0]); ++i){
+        try{
+            ok = Check(patches[i]) && ok;
+        }catch(std::exception const& _e){
+            std::cout << "FAIL " << patches[i] << " (" << _e.what() << ")" << std::endl;
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
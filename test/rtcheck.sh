@@ -0,0 +1,38 @@
+#!/bin/sh
+# plays test/rtcheck_session.txt through a tsynth built with
+# ./waf configure --rtcheck build, recomposing, moving parameters and
+# mapping controllers while it plays, and fails unless the audio
+# thread never allocated, locked or blocked.
+#
+#   $ test/rtcheck.sh [path to tsynth, build/tsynth by default]
+
+dir=$(cd "$(dirname "$0")" && pwd)
+tsynth=${1:-$dir/../build/tsynth}
+out=${TMPDIR:-/tmp}/tsynth_rtcheck.$$
+trap 'rm -f "$out.wav" "$out.log"' EXIT
+
+{
+    echo 'compose "(SynthVCA[0.5 0.02 0.08 0.5 0.2] (SynthVCF[0.01 0.6 0.8 0.2] (Mixer SynthVCO[SAW 0.05 0.2 0.3 1.5] SynthVCO[SQU 0.01 0.2 0.3 1.5])))"'
+    echo 'modmap bend SynthVCO0.tune -2 2'
+    echo 'modmap cc1 SynthVCF0.cutoff 1 8 exp'
+    echo start
+    sleep 1
+    echo 'compose "(SynthVCA[0.5 0.01 0.1 1.0 0.1] (SynthVCF[0.01 0.6 0.8 0.2] cutoff*1.5:v=SynthLFO[TRI 2 KEY] (Mixer[1,0.5] SynthVCO[SAW 0 0 1 0.1] (SynthVCO[SQU 0 0 1 0.1] tune*0.5:$v) SynthNoise[PINK])))"'
+    echo 'param SynthVCF0.cutoff 3'
+    sleep 1
+    echo 'compose "(SynthVCA[0.5 0.02 0.08 0.5 0.2] (SynthVCF[0.01 0.6 0.8 0.2] (Mixer SynthVCO[SAW 0.05 0.2 0.3 1.5 4,25,0.8] SynthVCO[SQU 0.01 0.2 0.3 1.5])))"'
+    echo 'param SynthVCO0.spread 0.5'
+    echo 'modmap pressure SynthVCA0.level 0 1'
+    sleep 1
+    echo stop
+    echo rtcheck
+    echo quit
+} | "$tsynth" --midi=replay:"$dir/rtcheck_session.txt" --output=wav:"$out.wav"@0 > "$out.log" 2>&1
+
+cat "$out.log"
+violations=$(sed -n 's/^.*violations: \([0-9]*\).*$/\1/p' "$out.log")
+if [ -z "$violations" ]; then
+    echo "rtcheck.sh: no report, is $tsynth built with --rtcheck?" >&2
+    exit 1
+fi
+[ "$violations" -eq 0 ]
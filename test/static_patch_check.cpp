@@ -0,0 +1,74 @@
+//-----------------------------------------------------------
+//    static_patch_check.cpp
+//        renders a StaticVoice and the MonoSynth composed from
+//        the same patch string and fails unless they match,
+//        sample for sample
+//-----------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "type.h"
+#include "midi_utility.h"
+#include "mono_synth.h"
+#include "static_patch.h"
+
+namespace{
+    using namespace TSynth;
+    using namespace TSynth::StaticPatch;
+
+    std::size_t const block = 256;
+    // about two seconds
+    std::size_t const frames = 344 * block;
+
+    typedef VCA<VCF<Mix<VCO, VCO>>> Flagship;
+
+    char const* const flagship =
+        "(SynthVCA[0.5 0.02 0.08 0.5 0.2] (SynthVCF[0.01 0.6 0.8 0.2] "
+        "(Mixer SynthVCO[SAW 0.05 0.2 0.3 1.5] SynthVCO[SQU 0.01 0.2 0.3 1.5])))";
+
+    // two notes, the second taking over the voice, then a release
+    template<typename Voice>
+    std::vector<Real> Render(Voice& _voice)
+    {
+        std::vector<Real> out(frames, 0.0);
+        for(std::size_t i = 0; i < frames; i += block){
+            if(i == 0) _voice.MidiReceive(sykes::midi::make_message(0x90, 57, 100));
+            if(i == frames / 4) _voice.MidiReceive(sykes::midi::make_message(0x90, 64, 80));
+            if(i == frames * 3 / 4) _voice.MidiReceive(sykes::midi::make_message(0x80, 64, 0));
+            _voice.Render(&out[i], block);
+        }
+        return out;
+    }
+}
+
+int main()
+{
+    StaticVoice<Flagship> voice(
+        MakeVCA(SynthVCA(0.5, 0.02, 0.08, 0.5, 0.2),
+        MakeVCF(SynthVCF(0.01, 0.6, 0.8, 0.2),
+        MakeMix(
+            MakeVCO(SynthVCO(WaveType::SAW, 0.05, 0.2, 0.3, 1.5)),
+            MakeVCO(SynthVCO(WaveType::SQU, 0.01, 0.2, 0.3, 1.5))))));
+
+    MonoSynth synth;
+    if(!synth.ComposeMonoSynthFromString(flagship)){
+        std::cout << "FAIL " << flagship << " (compose failed)" << std::endl;
+        return 1;
+    }
+    synth.SetVoice(0);
+
+    std::vector<Real> const expected = Render(synth);
+    std::vector<Real> const actual = Render(voice);
+    Real diff = 0.0;
+    Real peak = 0.0;
+    for(std::size_t i = 0; i < frames; ++i){
+        diff = std::max(diff, std::fabs(actual[i] - expected[i]));
+        peak = std::max(peak, std::fabs(expected[i]));
+    }
+    bool const ok = (diff == 0.0 && peak != 0.0);
+    std::cout << (ok ? "ok   " : "FAIL ") << "StaticVoice<VCA<VCF<Mix<VCO, VCO>>>>"
+        << " (peak " << peak << ", diff " << diff << ")" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -167,9 +167,14 @@ namespace creek
             m_foot(m_root), m_foot_obj(), m_size(), m_alloc()
         {}
         
+        explicit tree(allocator_type const& _alloc)
+            : m_root_list(), m_root(m_root_list.begin()),
+            m_foot(m_root), m_foot_obj(), m_size(), m_alloc(_alloc)
+        {}
+        
         tree(tree const& _other)
             : m_root_list(), m_root(m_root_list.begin()),
-                m_foot(m_root), m_foot_obj(), m_size(), m_alloc()
+                m_foot(m_root), m_foot_obj(), m_size(), m_alloc(_other.m_alloc)
         {
             if(_other.size() != 0){
                 const_preorder_iterator iother = _other.preorder_begin(), other_end = _other.preorder_end();
@@ -191,6 +196,10 @@ namespace creek
         ~tree()
         { clear(); }
         
+        //---- get_allocator
+        allocator_type get_allocator() const
+        { return allocator_type(m_alloc); }
+        
         //---- size
         size_type size() const
         { return m_size; }
@@ -437,8 +446,8 @@ namespace creek
             std::swap(m_foot_obj, _other.m_foot_obj);
             std::swap(m_size, _other.m_size);
             std::swap(m_alloc, _other.m_alloc);
-            (*m_foot) = &m_foot_obj;
-            (*_other.m_foot) = &(_other.m_foot_obj);
+            repoint_foot();
+            _other.repoint_foot();
         }
         
         //
@@ -483,6 +492,15 @@ namespace creek
         }
         
     private:
+        //---- repoint foot
+        // after swap the foot objects stay where they are. an empty
+        // tree has no foot entry, only its own end().
+        void repoint_foot()
+        {
+            if(m_size != 0) (*m_foot) = &m_foot_obj;
+            else m_root = m_foot = m_root_list.begin();
+        }
+        
         //---- create node
         node_pointer create_node(node_type const& _node)
         {
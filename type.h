@@ -46,7 +46,11 @@ namespace TSynth{
         SIN = 201,
         SAW = 202,
         TRI = 203,
-        SQU = 204
+        SQU = 204,
+        // band-limited, computed per sample with PolyBLEP / PolyBLAMP
+        BLSAW = 205,
+        BLTRI = 206,
+        BLSQU = 207
     };
     
     //-----------------------------------------------------------
@@ -67,6 +71,108 @@ namespace TSynth{
     
     template<typename T>
     struct IsMidiReceivable : public std::is_base_of<MidiReceivable, T> {};
+    
+    //-----------------------------------------------------------
+    //    MidiMaskOf
+    //        message kinds (sykes::midi::message_kind_bit) a mod
+    //        wants, from a public static midi_mask. mods without
+    //        one get everything.
+    //-----------------------------------------------------------
+    template<typename T>
+    struct MidiMaskOf
+    {
+    private:
+        template<typename U>
+        static std::integral_constant<std::uint8_t, U::midi_mask> Check(int);
+        template<typename U>
+        static std::integral_constant<std::uint8_t, 0xFF> Check(...);
+    public:
+        static std::uint8_t const value = decltype(Check<T>(0))::value;
+    };
+    
+    //-----------------------------------------------------------
+    //    ModParam
+    //        a value of a mod that can be changed while the patch
+    //        plays. a mod lists its parameters in a public static
+    //        ModParamList params; smooth ones are ramped.
+    //-----------------------------------------------------------
+    struct ModParam
+    {
+        char const* name;
+        Real (*get)(void const*);
+        void (*set)(void*, Real);
+        bool smooth;
+    };
+    
+    struct ModParamList
+    {
+        ModParam const* params;
+        std::size_t size;
+    };
+    
+    template<typename T, Real (T::*Get)() const>
+    inline Real ModParamGet(void const* _mod)
+    {
+        return (static_cast<T const*>(_mod)->*Get)();
+    }
+    
+    template<typename T, void (T::*Set)(Real)>
+    inline void ModParamSet(void* _mod, Real _v)
+    {
+        (static_cast<T*>(_mod)->*Set)(_v);
+    }
+    
+    template<typename T>
+    struct ModParamsOf
+    {
+    private:
+        template<typename U>
+        static ModParamList Get(decltype(&U::params)) { return U::params; }
+        template<typename U>
+        static ModParamList Get(...) { return ModParamList{0, 0}; }
+    public:
+        static ModParamList Get() { return Get<T>(0); }
+    };
+    
+    //-----------------------------------------------------------
+    //    SampleRateOf
+    //        calls SetSampleRate(std::size_t) of a mod that runs
+    //        at a rate of its own, e.g. under Oversample. mods
+    //        without one ignore the rate.
+    //-----------------------------------------------------------
+    template<typename T>
+    struct SampleRateOf
+    {
+    private:
+        template<typename U>
+        static auto Set(U& _mod, std::size_t _sr, int)
+            -> decltype(_mod.SetSampleRate(_sr), void())
+        { _mod.SetSampleRate(_sr); }
+        template<typename U>
+        static void Set(U&, std::size_t, ...) {}
+    public:
+        static void Set(T& _mod, std::size_t _sr) { Set<T>(_mod, _sr, 0); }
+    };
+    
+    //-----------------------------------------------------------
+    //    VoiceOf
+    //        calls SetVoice(std::size_t) of a mod that needs to
+    //        know which voice it is in, e.g. for a seed of its own.
+    //        the number is unique over all parts.
+    //-----------------------------------------------------------
+    template<typename T>
+    struct VoiceOf
+    {
+    private:
+        template<typename U>
+        static auto Set(U& _mod, std::size_t _voice, int)
+            -> decltype(_mod.SetVoice(_voice), void())
+        { _mod.SetVoice(_voice); }
+        template<typename U>
+        static void Set(U&, std::size_t, ...) {}
+    public:
+        static void Set(T& _mod, std::size_t _voice) { Set<T>(_mod, _voice, 0); }
+    };
 }//---- namespace
 #endif
 
@@ -0,0 +1,173 @@
+//-----------------------------------------------------------
+//    SynthVCF
+//-----------------------------------------------------------
+#ifndef SYNTH_VCF_H
+#define SYNTH_VCF_H
+
+#include <vector>
+#include <array>
+#include <tuple>
+#include <numeric>
+#include <algorithm>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+#include "eg.h"
+
+namespace TSynth{
+    // spacing of the filter table
+    Real const vcf_delta_freq =
+        (Real(Constants::vcf_max_cutoff - Constants::vcf_min_cutoff)
+        / Real(Constants::vcf_filter_table_size));
+    Real const vcf_inv_delta_freq = 1.0 / vcf_delta_freq;
+    
+    //-----------------------------------------------------------
+    //    class SynthVCF
+    //-----------------------------------------------------------
+    class SynthVCF : MidiReceivable
+    {
+    public:
+	    typedef Real result_type;
+        static std::uint8_t const midi_mask =
+            sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_ON)
+            | sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_OFF);
+	    static std::size_t const filter_order = 4;
+	    static ModParamList const params;
+	    
+	    SynthVCF();
+	    SynthVCF(Real _a, Real _d, Real _s, Real _r);
+	    
+        inline Real operator()(Real _in)
+        {
+	        Real cutoff = m_cutoff * m_cutoff_function();
+	        if(m_use_eg)
+	            cutoff *= m_cutoff_function();
+
+	        std::array<Real, filter_order + 1> itmp = {{0.0}};
+            std::array<Real, filter_order> otmp = m_c_buffer_output;
+
+	        std::copy(m_c_buffer_input.begin(),
+	            m_c_buffer_input.end(), itmp.begin());
+
+	        itmp.back() = _in;
+
+	        auto filt_consts = GetFilterConstants(cutoff * m_rate_scale);
+	        auto const& a = std::get<0>(filt_consts);
+	        auto const& b = std::get<1>(filt_consts);
+
+	        Real tmp = std::inner_product(m_c_buffer_input.begin(), m_c_buffer_input.end(), a.begin(), Real(0.0));
+            tmp -= std::inner_product(otmp.begin(), otmp.end(), b.begin(), Real(0.0));
+
+	        std::copy(itmp.begin() + 1, itmp.end(), m_c_buffer_input.begin());
+
+	        std::copy_backward(m_c_buffer_output.begin() + 1,
+	            m_c_buffer_output.end(),
+	            m_c_buffer_output.end() - 1);
+
+	        m_c_buffer_output.back() = tmp;
+
+	        m_last_val = tmp;
+	        return tmp;
+        }
+	    
+	    inline Real GetLastVal() const
+	    { return m_last_val; }
+	    
+	    inline void ResetCBuffers()
+	    {
+	        m_c_buffer_input.fill(0.0);
+	        m_c_buffer_output.fill(0.0);
+	    }
+	    
+	    inline void SetCutOffFrequency(Real _f)
+	    { m_cutoff = _f; }
+	    
+	    // cutoff over the frequency of the note, 2 by default
+	    inline void SetCutOffRatio(Real _r)
+	    {
+	        if(_r <= 0.0) return;
+	        m_cutoff_ratio = _r;
+	        SetCutOffFrequency(m_note_frequency * m_cutoff_ratio);
+	    }
+	    
+	    inline Real GetCutOffRatio() const
+	    { return m_cutoff_ratio; }
+	    
+	    // the table is for the base rate. at n times the rate the
+	    // coefficients of cutoff / n are the right ones
+	    inline void SetSampleRate(std::size_t _sr)
+	    {
+	        m_rate_scale = Real(SynthModBase::GetSampleRate()) / Real(_sr);
+	        m_cutoff_function.SetSampleRate(_sr);
+	    }
+	    
+	    inline SynthEG& GetEG()
+	    { return m_cutoff_function; }
+	    
+	    inline SynthEG const& GetEG() const
+	    { return m_cutoff_function; }
+	    
+	    inline void UseEG(bool _b = true)
+	    {
+	        m_use_eg = _b;
+	    }
+	    
+	    inline void MidiReceive(sykes::midi::message _m)
+        {
+            m_cutoff_function.MidiReceive(_m);
+            switch(sykes::midi::message::type(_m))
+            {
+                case sykes::midi::channel_voice_message_type::NOTE_ON:
+                {
+                    UInt8 note = sykes::midi::message::data1(_m);
+                    if(note < sykes::midi::note_table_size){
+                        m_note_frequency = sykes::midi::note_table[note];
+                        SetCutOffFrequency(m_note_frequency * m_cutoff_ratio);
+                    }
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+    private:
+	    Real m_cutoff;
+	    Real m_cutoff_ratio;
+	    Real m_note_frequency;
+	    Real m_last_val;
+	    Real m_rate_scale;
+	    std::array<Real,filter_order> m_c_buffer_input;
+	    std::array<Real, filter_order> m_c_buffer_output;
+	    SynthEG m_cutoff_function;
+	    bool m_use_eg;
+	    
+	    static void GetFilterConstants(Real _f, std::array<Real, filter_order + 1>& _a, std::array<Real, filter_order>& _b);
+        inline static std::tuple<std::array<Real, filter_order + 1> const&, std::array<Real, filter_order> const&>
+	        GetFilterConstants(Real _f)
+        {
+	        std::size_t n1 = 0;
+
+	        if(_f < Real(Constants::vcf_min_cutoff))
+		        n1 = 0;
+	        else if(_f > Real(Constants::vcf_max_cutoff))
+		        n1 = Constants::vcf_filter_table_size - 1;
+	        else{
+		        Real c1 = (_f - Real(Constants::vcf_min_cutoff)) * vcf_inv_delta_freq;
+		        n1 = std::size_t(c1);
+	        }
+
+	        return std::tuple<std::array<Real, filter_order + 1> const&, std::array<Real, filter_order> const&>
+	            (butterworth4_ai[n1], butterworth4_bi[n1]);
+        }
+	    
+	    static void CalcButterWorthConstants(Real _f, std::array<Real, filter_order + 1>& _a, std::array<Real, filter_order>& _b);
+	    static void SetFilterTable();
+	    static bool initialized_filter_table;
+	    static std::vector<std::array<Real, filter_order + 1>> butterworth4_ai;
+	    static std::vector<std::array<Real, filter_order>> butterworth4_bi;
+	    
+	    TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
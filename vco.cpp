@@ -2,114 +2,34 @@
 //    vco.cpp
 //-----------------------------------------------------------
 
-#include "constants.h"
-#include "type.h"
-#include "synth_mod.h"
-#include "eg.h"
 #include <cmath>
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include "vco.h"
 
 namespace TSynth{
-    //-----------------------------------------------------------
-    //    enum class WaveType
-    //-----------------------------------------------------------
-    inline WaveType StringToWaveType(std::string const& _str)
-    {
-        if(_str == "SIN") return WaveType::SIN;
-        if(_str == "SAW") return WaveType::SAW;
-        if(_str == "TRI") return WaveType::TRI;
-        if(_str == "SQU") return WaveType::SQU;
-        return WaveType::SIN;
-    }
+    TSYNTH_DECLARE_NULLARY_MOD(SynthVCO, (&StringToWaveType, StoD(), StoD(), StoD(), StoD()))
     
-    //-----------------------------------------------------------
-    //    class SynthVCO
-    //-----------------------------------------------------------
-    class SynthVCO : MidiReceivable
-    {
-    public:
-	    typedef Real result_type;
-        SynthVCO();
-        SynthVCO(WaveType _w, Real _a, Real _d, Real _s, Real _r);
-        
-        Real operator()();
-        
-        void SetFrequency(Real _f);
-        
-        inline Real GetLastVal() const
-        { return m_last_val; }
+    namespace{
+        // SynthVCO[<wave> <a> <d> <s> <r> <unison>,<detune>,<spread>]
+        std::string const vco_unison_key =
+            SynthModFactory::RegisterMod("SynthVCO", AModFactory<NullaryMod<SynthVCO>>(),
+                std::make_tuple(&StringToWaveType, StoD(), StoD(), StoD(), StoD(), sykes::nocast()));
         
-        inline WaveType GetWaveType() const
-        { return m_wtype; }
-        
-        inline void SetWaveType(WaveType _wt)
-        { m_wtype = _wt; }
-        
-        inline void ResetPhase()
-        { m_phase_position = 0.0; }
-        
-        inline static std::vector<Real> const& GetWaveTable(WaveType _wp)
-        {
-            if(!initialized_wave_table){
-                initialized_wave_table = false;
-                InitializeWaveTable();
-            }
-            
-            switch(_wp){
-                case WaveType::SIN:
-                    return sin_wave;
-                case WaveType::TRI:
-                    return tri_wave;
-                case WaveType::SAW:
-                    return saw_wave;
-                case WaveType::SQU:
-                    return squ_wave;
-                default:
-                    return sin_wave;
-            }
-        }
-        
-        inline void UseEG(bool _b = true)
-        {
-            m_use_eg = _b;
-        }
-        
-        inline void MidiReceive(sykes::midi::message _m)
-        {
-            m_freq_function.MidiReceive(_m);
-            switch(sykes::midi::message::status(_m))
-            {
-                case sykes::midi::channel_voice_message_type::NOTE_ON:
-                {
-                    UInt8 note = sykes::midi::message::data1(_m);
-                    if(note < sykes::midi::note_table_size)
-                        SetFrequency(sykes::midi::note_table[note]);
-                    return;
-                }
-                default:
-                    return;
-            }
-        }
-    private:
-        WaveType m_wtype;
-        Real m_frequency;
-        Real m_last_val;
-        Real m_phase_position;
-        Real m_delta_phase;
-        SynthEG m_freq_function;
-        bool m_use_eg;
-        
-        static bool initialized_wave_table;
-        static std::vector<Real> sin_wave;
-        static std::vector<Real> tri_wave;
-        static std::vector<Real> saw_wave;
-        static std::vector<Real> squ_wave;
-        
-        static void InitializeWaveTable();
-        
-        TSYNTH_USE_AS_MOD
-    };
+        ModParam const vco_params[] = {
+            {"tune", &ModParamGet<SynthVCO, &SynthVCO::GetTune>,
+                &ModParamSet<SynthVCO, &SynthVCO::SetTune>, true},
+            {"unison", &ModParamGet<SynthVCO, &SynthVCO::GetUnison>,
+                &ModParamSet<SynthVCO, &SynthVCO::SetUnison>, false},
+            {"detune", &ModParamGet<SynthVCO, &SynthVCO::GetDetune>,
+                &ModParamSet<SynthVCO, &SynthVCO::SetDetune>, true},
+            {"spread", &ModParamGet<SynthVCO, &SynthVCO::GetSpread>,
+                &ModParamSet<SynthVCO, &SynthVCO::SetSpread>, true},
+            TSYNTH_EG_PARAMS(SynthVCO)
+        };
+    }
     
-    TSYNTH_DECLARE_NULLARY_MOD(SynthVCO, (&StringToWaveType, StoD(), StoD(), StoD(), StoD()))
+    ModParamList const SynthVCO::params = {vco_params, sizeof(vco_params) / sizeof(vco_params[0])};
     
     //-----------------------------------------------------------
     //    
@@ -118,9 +38,7 @@ namespace TSynth{
     std::vector<Real> SynthVCO::sin_wave;
     std::vector<Real> SynthVCO::tri_wave;
     std::vector<Real> SynthVCO::saw_wave;
-    std::vector<Real> SynthVCO::squ_wave;
-    Real const min_delta_phase = Real(Constants::vco_wave_table_size)
-            * Constants::vco_min_frequency / Real(Constants::default_sample_rate);
+    std::vector<Real> SynthVCO::squ_wave;
 
     //-----------------------------------------------------------
     //    
@@ -128,16 +46,36 @@ namespace TSynth{
     SynthVCO::SynthVCO()
         : m_wtype(Constants::vco_default_wave_type),
         m_frequency(Real(Constants::vco_default_frequency)),
+        m_tune(0.0),
+        m_tune_ratio(1.0),
         m_last_val(),
         m_phase_position(),
         m_delta_phase((Real(Constants::vco_wave_table_size) * m_frequency / (Real)SynthModBase::GetSampleRate())),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_min_delta_phase(Real(Constants::vco_wave_table_size)
+            * Constants::vco_min_frequency / Real(SynthModBase::GetSampleRate())),
         m_freq_function(),
-        m_use_eg(true)
+        m_use_eg(true),
+        m_band_limited(IsBandLimited(m_wtype)),
+        m_unison(1),
+        m_detune(Constants::vco_default_detune),
+        m_spread(0.0),
+        m_channel(Channel::MONO),
+        m_lane_phase(),
+        m_lane_ratio(),
+        m_lane_gain()
     {
         if(!initialized_wave_table){
             initialized_wave_table = true;
             InitializeWaveTable();
         }
+        // the lanes start spread over the cycle so that they do not
+        // rise as one
+        for(std::size_t k = 0; k < Constants::vco_max_unison; ++k){
+            Real const x = Real(k) * 0.6180339887;
+            m_lane_phase[k] = (x - std::floor(x)) * Real(Constants::vco_wave_table_size);
+        }
+        UpdateLanes();
     }
 
     //-----------------------------------------------------------
@@ -146,16 +84,62 @@ namespace TSynth{
     SynthVCO::SynthVCO(WaveType _w, Real _a, Real _d, Real _s, Real _r)
         : m_wtype(_w),
         m_frequency(Real(Constants::vco_default_frequency)),
+        m_tune(0.0),
+        m_tune_ratio(1.0),
         m_last_val(),
         m_phase_position(),
         m_delta_phase((Real(Constants::vco_wave_table_size) * m_frequency / (Real)SynthModBase::GetSampleRate())),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_min_delta_phase(Real(Constants::vco_wave_table_size)
+            * Constants::vco_min_frequency / Real(SynthModBase::GetSampleRate())),
         m_freq_function(_a, _d, _s, _r),
-        m_use_eg(true)
+        m_use_eg(true),
+        m_band_limited(IsBandLimited(m_wtype)),
+        m_unison(1),
+        m_detune(Constants::vco_default_detune),
+        m_spread(0.0),
+        m_channel(Channel::MONO),
+        m_lane_phase(),
+        m_lane_ratio(),
+        m_lane_gain()
     {
         if(!initialized_wave_table){
             initialized_wave_table = true;
             InitializeWaveTable();
         }
+        // the lanes start spread over the cycle so that they do not
+        // rise as one
+        for(std::size_t k = 0; k < Constants::vco_max_unison; ++k){
+            Real const x = Real(k) * 0.6180339887;
+            m_lane_phase[k] = (x - std::floor(x)) * Real(Constants::vco_wave_table_size);
+        }
+        UpdateLanes();
+    }
+
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    SynthVCO::SynthVCO(WaveType _w, Real _a, Real _d, Real _s, Real _r, std::string const& _unison)
+        : SynthVCO(_w, _a, _d, _s, _r)
+    {
+        Real values[3] = {1.0, Constants::vco_default_detune, 0.0};
+        std::size_t i = 0;
+        std::string::size_type begin = 0;
+        while(begin <= _unison.size()){
+            std::string::size_type end = _unison.find(',', begin);
+            if(end == std::string::npos) end = _unison.size();
+            if(i >= 3)
+                throw std::runtime_error("SynthVCO: bad unison: " + _unison);
+            try{
+                values[i++] = boost::lexical_cast<Real>(_unison.substr(begin, end - begin));
+            }catch(boost::bad_lexical_cast const&){
+                throw std::runtime_error("SynthVCO: bad unison: " + _unison);
+            }
+            begin = end + 1;
+        }
+        m_detune = (values[1] < 0.0) ? 0.0 : values[1];
+        SetSpread(values[2]);
+        SetUnison(values[0]);
     }
 
     //-----------------------------------------------------------
@@ -170,30 +154,96 @@ namespace TSynth{
         else
             m_frequency = _f;
         m_delta_phase = Real(Constants::vco_wave_table_size)
-            * m_frequency / Real(SynthModBase::GetSampleRate());
+            * m_frequency * m_tune_ratio / Real(m_sample_rate);
     }
     
     //-----------------------------------------------------------
     //    
     //-----------------------------------------------------------
-    Real SynthVCO::operator()()
+    void SynthVCO::SetSampleRate(std::size_t _sr)
     {
-        auto const& wave = GetWaveTable(m_wtype);
-        if(m_use_eg){
-            Real tmp = m_delta_phase * m_freq_function();
-            if(tmp >= min_delta_phase)
-                m_phase_position += tmp;
-            else
-                m_phase_position += min_delta_phase;
-        }else
-            m_phase_position += m_delta_phase;
-        
-        if(m_phase_position >= Real(Constants::vco_wave_table_size))
-            m_phase_position -= Real(Constants::vco_wave_table_size);
-        
-        m_last_val = wave[static_cast<std::size_t>(m_phase_position)];
-        
-        return m_last_val;
+        if(_sr == 0) return;
+        m_sample_rate = _sr;
+        m_min_delta_phase = Real(Constants::vco_wave_table_size)
+            * Constants::vco_min_frequency / Real(_sr);
+        m_freq_function.SetSampleRate(_sr);
+        SetFrequency(m_frequency);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthVCO::SetTune(Real _semitones)
+    {
+        m_tune = _semitones;
+        m_tune_ratio = std::pow(2.0, _semitones / 12.0);
+        SetFrequency(m_frequency);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthVCO::SetUnison(Real _count)
+    {
+        if(_count < 1.0)
+            m_unison = 1;
+        else if(_count > Real(Constants::vco_max_unison))
+            m_unison = Constants::vco_max_unison;
+        else
+            m_unison = static_cast<std::size_t>(_count + 0.5);
+        UpdateLanes();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthVCO::SetDetune(Real _cents)
+    {
+        m_detune = (_cents < 0.0) ? 0.0 : _cents;
+        UpdateLanes();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthVCO::SetSpread(Real _spread)
+    {
+        m_spread = (_spread < 0.0) ? 0.0 : (_spread > 1.0) ? 1.0 : _spread;
+        UpdateLanes();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthVCO::SetChannel(Channel _channel)
+    {
+        m_channel = _channel;
+        UpdateLanes();
+    }
+    
+    //-----------------------------------------------------------
+    //    lanes are spaced evenly over the detune, the sum is scaled
+    //    by 1 / sqrt(n) to keep the loudness of uncorrelated lanes.
+    //    the pans alternate sides from the middle of the detune
+    //    out, so both sides get low and high lanes; a side takes
+    //    1 - pan and 1 + pan of a lane, the two average to mono.
+    //-----------------------------------------------------------
+    void SynthVCO::UpdateLanes()
+    {
+        Real const gain = 1.0 / std::sqrt(Real(m_unison));
+        Real const side = (m_channel == Channel::LEFT) ? -1.0 : (m_channel == Channel::RIGHT) ? 1.0 : 0.0;
+        for(std::size_t k = 0; k < Constants::vco_max_unison; ++k){
+            if(k < m_unison && m_unison > 1){
+                Real const position = Real(k) / Real(m_unison - 1) - 0.5;
+                Real const cents = m_detune * position;
+                Real const pan = m_spread * 2.0 * std::fabs(position) * ((k % 2 == 0) ? -1.0 : 1.0);
+                m_lane_ratio[k] = std::pow(2.0, cents / 1200.0);
+                m_lane_gain[k] = gain * (1.0 + side * pan);
+            }else{
+                m_lane_ratio[k] = 1.0;
+                m_lane_gain[k] = 0.0;
+            }
+        }
     }
     
     //-----------------------------------------------------------
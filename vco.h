@@ -0,0 +1,384 @@
+//-----------------------------------------------------------
+//    SynthVCO
+//-----------------------------------------------------------
+#ifndef SYNTH_VCO_H
+#define SYNTH_VCO_H
+
+#include <array>
+#include <vector>
+#include <string>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+#include "eg.h"
+
+namespace TSynth{
+    //-----------------------------------------------------------
+    //    enum class WaveType
+    //-----------------------------------------------------------
+    inline WaveType StringToWaveType(std::string const& _str)
+    {
+        if(_str == "SIN") return WaveType::SIN;
+        if(_str == "SAW") return WaveType::SAW;
+        if(_str == "TRI") return WaveType::TRI;
+        if(_str == "SQU") return WaveType::SQU;
+        if(_str == "BLSAW") return WaveType::BLSAW;
+        if(_str == "BLTRI") return WaveType::BLTRI;
+        if(_str == "BLSQU") return WaveType::BLSQU;
+        return WaveType::SIN;
+    }
+    
+    inline bool IsBandLimited(WaveType _w)
+    {
+        return _w == WaveType::BLSAW || _w == WaveType::BLTRI || _w == WaveType::BLSQU;
+    }
+    
+    //-----------------------------------------------------------
+    //    PolyBLEP, PolyBLAMP
+    //        two-sample polynomial residuals of a band-limited step
+    //        and ramp. _t is the phase in cycles, _dt the phase step
+    //        per sample in cycles. no tables, only a few products.
+    //-----------------------------------------------------------
+    inline Real PolyBLEP(Real _t, Real _dt)
+    {
+        if(_t < _dt){
+            Real const x = _t / _dt;
+            return x + x - x * x - 1.0;
+        }
+        if(_t > 1.0 - _dt){
+            Real const x = (_t - 1.0) / _dt;
+            return x * x + x + x + 1.0;
+        }
+        return 0.0;
+    }
+    
+    inline Real PolyBLAMP(Real _t, Real _dt)
+    {
+        if(_t < _dt){
+            Real const x = _t / _dt - 1.0;
+            return -x * x * x / 3.0;
+        }
+        if(_t > 1.0 - _dt){
+            Real const x = (_t - 1.0) / _dt + 1.0;
+            return x * x * x / 3.0;
+        }
+        return 0.0;
+    }
+    
+    // same phase and level as the tables: saw rises from -1, tri
+    // starts at -1 and peaks at half the cycle, squ is 1 first
+    inline Real BandLimitedSaw(Real _t, Real _dt)
+    {
+        return 2.0 * _t - 1.0 - PolyBLEP(_t, _dt);
+    }
+    
+    inline Real BandLimitedSquare(Real _t, Real _dt)
+    {
+        Real const t2 = (_t < 0.5) ? _t + 0.5 : _t - 0.5;
+        return ((_t < 0.5) ? 1.0 : -1.0) + PolyBLEP(_t, _dt) - PolyBLEP(t2, _dt);
+    }
+    
+    inline Real BandLimitedTriangle(Real _t, Real _dt)
+    {
+        Real const t2 = (_t < 0.5) ? _t + 0.5 : _t - 0.5;
+        Real const naive = (_t < 0.5) ? (4.0 * _t - 1.0) : (3.0 - 4.0 * _t);
+        return naive + 4.0 * _dt * (PolyBLAMP(_t, _dt) - PolyBLAMP(t2, _dt));
+    }
+    
+    //-----------------------------------------------------------
+    //    class SynthVCO
+    //-----------------------------------------------------------
+    class SynthVCO : MidiReceivable
+    {
+    public:
+	    typedef Real result_type;
+        static std::uint8_t const midi_mask =
+            sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_ON)
+            | sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_OFF);
+        static ModParamList const params;
+        
+        // the side of the stereo field a SynthVCO renders. a voice
+        // with a spread unison is played twice, once per side
+        enum class Channel
+        {
+            MONO,
+            LEFT,
+            RIGHT
+        };
+        
+        SynthVCO();
+        SynthVCO(WaveType _w, Real _a, Real _d, Real _s, Real _r);
+        // _unison is <unison>[,<detune>[,<spread>]]
+        SynthVCO(WaveType _w, Real _a, Real _d, Real _s, Real _r, std::string const& _unison);
+        
+        inline Real operator()()
+        {
+            if(m_unison > 1) return Unison();
+            
+            Real step = m_delta_phase;
+            if(m_use_eg){
+                step *= m_freq_function();
+                if(step < m_min_delta_phase) step = m_min_delta_phase;
+            }
+            m_phase_position += step;
+        
+            if(m_phase_position >= Real(Constants::vco_wave_table_size))
+                m_phase_position -= Real(Constants::vco_wave_table_size);
+        
+            if(m_band_limited)
+                m_last_val = BandLimited(m_phase_position, step);
+            else
+                m_last_val = GetWaveTable(m_wtype)[static_cast<std::size_t>(m_phase_position)];
+        
+            return m_last_val;
+        }
+        
+        void SetFrequency(Real _f);
+        
+        void SetSampleRate(std::size_t _sr);
+        
+        // offset from the note in semitones
+        void SetTune(Real _semitones);
+        
+        inline Real GetTune() const
+        { return m_tune; }
+        
+        // number of detuned oscillators, 1 to Constants::vco_max_unison
+        void SetUnison(Real _count);
+        
+        inline Real GetUnison() const
+        { return Real(m_unison); }
+        
+        // spread of the unison oscillators in cents, from the lowest
+        // to the highest
+        void SetDetune(Real _cents);
+        
+        inline Real GetDetune() const
+        { return m_detune; }
+        
+        // pan of the outermost unison oscillators, 0 for all in the
+        // middle to 1 for hard left and right
+        void SetSpread(Real _spread);
+        
+        inline Real GetSpread() const
+        { return m_spread; }
+        
+        // true if the unison is spread over the stereo field
+        inline bool IsStereo() const
+        { return m_unison > 1 && m_spread > 0.0; }
+        
+        void SetChannel(Channel _channel);
+        
+        inline Channel GetChannel() const
+        { return m_channel; }
+        
+        inline Real GetLastVal() const
+        { return m_last_val; }
+        
+        inline WaveType GetWaveType() const
+        { return m_wtype; }
+        
+        inline void SetWaveType(WaveType _wt)
+        {
+            m_wtype = _wt;
+            m_band_limited = IsBandLimited(_wt);
+        }
+        
+        inline void ResetPhase()
+        { m_phase_position = 0.0; }
+        
+        inline SynthEG& GetEG()
+        { return m_freq_function; }
+        
+        inline SynthEG const& GetEG() const
+        { return m_freq_function; }
+        
+        inline static std::vector<Real> const& GetWaveTable(WaveType _wp)
+        {
+            if(!initialized_wave_table){
+                initialized_wave_table = false;
+                InitializeWaveTable();
+            }
+            
+            switch(_wp){
+                case WaveType::SIN:
+                    return sin_wave;
+                case WaveType::TRI:
+                    return tri_wave;
+                case WaveType::SAW:
+                    return saw_wave;
+                case WaveType::SQU:
+                    return squ_wave;
+                default:
+                    return sin_wave;
+            }
+        }
+        
+        inline void UseEG(bool _b = true)
+        {
+            m_use_eg = _b;
+        }
+        
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            m_freq_function.MidiReceive(_m);
+            switch(sykes::midi::message::type(_m))
+            {
+                case sykes::midi::channel_voice_message_type::NOTE_ON:
+                {
+                    UInt8 note = sykes::midi::message::data1(_m);
+                    if(note < sykes::midi::note_table_size)
+                        SetFrequency(sykes::midi::note_table[note]);
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+    private:
+        typedef std::array<Real, Constants::vco_max_unison> lanes_type;
+        
+        //-----------------------------------------------------------
+        //    unison
+        //        all Constants::vco_max_unison lanes run every sample,
+        //        the unused ones with gain 0. the fixed trip count and
+        //        the branch-free shapes let the compiler unroll the
+        //        lane loop into vector instructions.
+        //-----------------------------------------------------------
+        struct SawShape
+        {
+            inline Real operator()(Real _p, Real) const
+            { return -1.0 + _p * (2.0 / Real(Constants::vco_wave_table_size)); }
+        };
+        
+        struct TriShape
+        {
+            inline Real operator()(Real _p, Real) const
+            {
+                Real const x = _p * (4.0 / Real(Constants::vco_wave_table_size));
+                return (x < 2.0) ? (x - 1.0) : (3.0 - x);
+            }
+        };
+        
+        struct SquShape
+        {
+            inline Real operator()(Real _p, Real) const
+            { return (_p < Real(Constants::vco_wave_table_size / 2)) ? 1.0 : -1.0; }
+        };
+        
+        struct TableShape
+        {
+            std::vector<Real> const* table;
+            inline Real operator()(Real _p, Real) const
+            { return (*table)[static_cast<std::size_t>(_p)]; }
+        };
+        
+        template<WaveType W>
+        struct BandLimitedShape
+        {
+            inline Real operator()(Real _p, Real _step) const
+            { return BandLimited(W, _p, _step); }
+        };
+        
+        // _p and _step in table positions
+        inline static Real BandLimited(WaveType _type, Real _p, Real _step)
+        {
+            Real const scale = 1.0 / Real(Constants::vco_wave_table_size);
+            Real const t = _p * scale;
+            Real const dt = _step * scale;
+            switch(_type){
+                case WaveType::BLTRI: return BandLimitedTriangle(t, dt);
+                case WaveType::BLSQU: return BandLimitedSquare(t, dt);
+                default: return BandLimitedSaw(t, dt);
+            }
+        }
+        
+        inline Real BandLimited(Real _p, Real _step) const
+        {
+            return BandLimited(m_wtype, _p, _step);
+        }
+        
+        template<typename Shape>
+        inline Real UnisonLanes(Real _step, Shape _shape)
+        {
+            Real const size = Real(Constants::vco_wave_table_size);
+            Real sum = 0.0;
+            for(std::size_t k = 0; k < Constants::vco_max_unison; ++k){
+                Real const step = _step * m_lane_ratio[k];
+                Real p = m_lane_phase[k] + step;
+                p -= (p >= size) ? size : 0.0;
+                m_lane_phase[k] = p;
+                sum += m_lane_gain[k] * _shape(p, step);
+            }
+            return sum;
+        }
+        
+        inline Real Unison()
+        {
+            Real step = m_delta_phase;
+            if(m_use_eg){
+                step *= m_freq_function();
+                if(step < m_min_delta_phase) step = m_min_delta_phase;
+            }
+            switch(m_wtype){
+                case WaveType::SAW:
+                    m_last_val = UnisonLanes(step, SawShape());
+                    break;
+                case WaveType::TRI:
+                    m_last_val = UnisonLanes(step, TriShape());
+                    break;
+                case WaveType::SQU:
+                    m_last_val = UnisonLanes(step, SquShape());
+                    break;
+                case WaveType::BLSAW:
+                    m_last_val = UnisonLanes(step, BandLimitedShape<WaveType::BLSAW>());
+                    break;
+                case WaveType::BLTRI:
+                    m_last_val = UnisonLanes(step, BandLimitedShape<WaveType::BLTRI>());
+                    break;
+                case WaveType::BLSQU:
+                    m_last_val = UnisonLanes(step, BandLimitedShape<WaveType::BLSQU>());
+                    break;
+                default:
+                    m_last_val = UnisonLanes(step, TableShape{&GetWaveTable(m_wtype)});
+                    break;
+            }
+            return m_last_val;
+        }
+        
+        void UpdateLanes();
+        
+        WaveType m_wtype;
+        Real m_frequency;
+        Real m_tune;
+        Real m_tune_ratio;
+        Real m_last_val;
+        Real m_phase_position;
+        Real m_delta_phase;
+        std::size_t m_sample_rate;
+        // slowest phase step while the frequency eg runs
+        Real m_min_delta_phase;
+        SynthEG m_freq_function;
+        bool m_use_eg;
+        bool m_band_limited;
+        std::size_t m_unison;
+        Real m_detune;
+        Real m_spread;
+        Channel m_channel;
+        lanes_type m_lane_phase;
+        lanes_type m_lane_ratio;
+        lanes_type m_lane_gain;
+        
+        static bool initialized_wave_table;
+        static std::vector<Real> sin_wave;
+        static std::vector<Real> tri_wave;
+        static std::vector<Real> saw_wave;
+        static std::vector<Real> squ_wave;
+        
+        static void InitializeWaveTable();
+        
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif
@@ -0,0 +1,121 @@
+//-----------------------------------------------------------
+//    wav_pcm_out.cpp
+//-----------------------------------------------------------
+#include <cstring>
+#include <stdexcept>
+#include "wav_pcm_out.h"
+
+namespace sykes{
+
+    namespace{
+        inline unsigned char* put_le16(unsigned char* _p, std::uint16_t _v)
+        {
+            _p[0] = static_cast<unsigned char>(_v & 0xFF);
+            _p[1] = static_cast<unsigned char>((_v >> 8) & 0xFF);
+            return _p + 2;
+        }
+
+        inline unsigned char* put_le32(unsigned char* _p, std::uint32_t _v)
+        {
+            _p[0] = static_cast<unsigned char>(_v & 0xFF);
+            _p[1] = static_cast<unsigned char>((_v >> 8) & 0xFF);
+            _p[2] = static_cast<unsigned char>((_v >> 16) & 0xFF);
+            _p[3] = static_cast<unsigned char>((_v >> 24) & 0xFF);
+            return _p + 4;
+        }
+
+        inline unsigned char* put_le64(unsigned char* _p, std::uint64_t _v)
+        {
+            _p = put_le32(_p, std::uint32_t(_v & 0xFFFFFFFF));
+            return put_le32(_p, std::uint32_t(_v >> 32));
+        }
+
+        // RIFF, JUNK or ds64, fmt and data
+        std::size_t const wav_ds64_size = 28;
+        std::size_t const wav_header_size = 12 + (8 + wav_ds64_size) + 24 + 8;
+        std::uint16_t const wav_format_ieee_float = 3;
+        std::uint32_t const wav_size_in_ds64 = 0xFFFFFFFF;
+    }
+
+    wav_pcm_out::wav_pcm_out(std::string const& _path, std::size_t _sample_rate, std::size_t _buffer_size, double _speed)
+        :
+        clocked_pcm_out(_sample_rate, _buffer_size, _speed),
+        m_file(std::fopen(_path.c_str(), "wb")),
+        m_data_bytes(0),
+        m_bytes(_buffer_size * m_channel_count * sizeof(float), 0)
+    {
+        if(!m_file) throw std::runtime_error("wav_pcm_out::wav_pcm_out() cannot open " + _path);
+        write_header();
+    }
+
+    wav_pcm_out::~wav_pcm_out()
+    {
+        stop();
+        std::fclose(m_file);
+    }
+
+    void wav_pcm_out::stop()
+    {
+        clocked_pcm_out::stop();
+        write_header();
+        std::fseek(m_file, 0, SEEK_END);
+        std::fflush(m_file);
+    }
+
+    void wav_pcm_out::deliver(buffer_format_type const* _frames, std::size_t _frame_count)
+    {
+        std::size_t const samples = _frame_count * m_channel_count;
+        unsigned char* p = &m_bytes[0];
+        for(std::size_t i = 0; i < samples; ++i){
+            std::uint32_t bits;
+            std::memcpy(&bits, &_frames[i], sizeof(bits));
+            p = put_le32(p, bits);
+        }
+        std::size_t const bytes = samples * sizeof(float);
+        if(std::fwrite(&m_bytes[0], 1, bytes, m_file) == bytes)
+            m_data_bytes += bytes;
+    }
+
+    // a plain RIFF header while the sizes fit in 32 bits, RF64 after
+    void wav_pcm_out::write_header()
+    {
+        unsigned char header[wav_header_size];
+        unsigned char* p = header;
+        std::uint32_t const rate = std::uint32_t(sample_rate());
+        std::uint16_t const block_align = std::uint16_t(m_channel_count * sizeof(float));
+        std::uint64_t const riff_bytes = std::uint64_t(wav_header_size - 8) + m_data_bytes;
+        bool const rf64 = (riff_bytes >= wav_size_in_ds64);
+
+        if(rf64){
+            std::memcpy(p, "RF64", 4); p += 4;
+            p = put_le32(p, wav_size_in_ds64);
+            std::memcpy(p, "WAVE", 4); p += 4;
+            std::memcpy(p, "ds64", 4); p += 4;
+            p = put_le32(p, std::uint32_t(wav_ds64_size));
+            p = put_le64(p, riff_bytes);
+            p = put_le64(p, m_data_bytes);
+            p = put_le64(p, m_data_bytes / block_align);
+            p = put_le32(p, 0);
+        }else{
+            std::memcpy(p, "RIFF", 4); p += 4;
+            p = put_le32(p, std::uint32_t(riff_bytes));
+            std::memcpy(p, "WAVE", 4); p += 4;
+            std::memcpy(p, "JUNK", 4); p += 4;
+            p = put_le32(p, std::uint32_t(wav_ds64_size));
+            std::memset(p, 0, wav_ds64_size); p += wav_ds64_size;
+        }
+        std::memcpy(p, "fmt ", 4); p += 4;
+        p = put_le32(p, 16);
+        p = put_le16(p, wav_format_ieee_float);
+        p = put_le16(p, std::uint16_t(m_channel_count));
+        p = put_le32(p, rate);
+        p = put_le32(p, rate * block_align);
+        p = put_le16(p, block_align);
+        p = put_le16(p, 32);
+        std::memcpy(p, "data", 4); p += 4;
+        p = put_le32(p, (rf64) ? wav_size_in_ds64 : std::uint32_t(m_data_bytes));
+
+        std::fseek(m_file, 0, SEEK_SET);
+        std::fwrite(header, 1, wav_header_size, m_file);
+    }
+}//----
@@ -0,0 +1,42 @@
+//-----------------------------------------------------------
+//    wav_pcm_out
+//-----------------------------------------------------------
+#ifndef SYKES_WAV_PCM_OUT_H
+#define SYKES_WAV_PCM_OUT_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "clocked_pcm_out.h"
+
+namespace sykes{
+
+    //-----------------------------------------------------------
+    //    class wav_pcm_out
+    //        streams every period into a 32bit float stereo wav
+    //        file. the header sizes are patched whenever the
+    //        output is stopped, so the file is valid after each stop.
+    //        a JUNK chunk keeps room for a ds64 chunk, which takes
+    //        its place when the file grows past 4GiB and the header
+    //        becomes an RF64 one.
+    //-----------------------------------------------------------
+    class wav_pcm_out
+        : public clocked_pcm_out
+    {
+    public:
+        wav_pcm_out(std::string const& _path, std::size_t _sample_rate, std::size_t _buffer_size, double _speed = 1.0);
+        ~wav_pcm_out();
+
+        void stop();
+
+    private:
+        std::FILE* m_file;
+        std::uint64_t m_data_bytes;
+        std::vector<unsigned char> m_bytes;
+
+        void deliver(buffer_format_type const* _frames, std::size_t _frame_count);
+        void write_header();
+    };
+}//----
+#endif
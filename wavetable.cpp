@@ -0,0 +1,135 @@
+//-----------------------------------------------------------
+//    wavetable.cpp
+//-----------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include "wavetable.h"
+#include "mapped_wav.h"
+#include "constants.h"
+
+namespace TSynth{
+
+    namespace{
+        typedef std::complex<double> complex_type;
+
+        // in place radix 2, _sign -1 forward, 1 inverse without the 1/n
+        void FFT(std::vector<complex_type>& _x, double _sign)
+        {
+            std::size_t const n = _x.size();
+            for(std::size_t i = 1, j = 0; i < n; ++i){
+                std::size_t bit = n >> 1;
+                for(; j & bit; bit >>= 1) j ^= bit;
+                j ^= bit;
+                if(i < j) std::swap(_x[i], _x[j]);
+            }
+            for(std::size_t len = 2; len <= n; len <<= 1){
+                double const a = _sign * 2.0 * M_PI / double(len);
+                complex_type const w(std::cos(a), std::sin(a));
+                for(std::size_t i = 0; i < n; i += len){
+                    complex_type t(1.0, 0.0);
+                    for(std::size_t k = 0; k < len / 2; ++k, t *= w){
+                        complex_type const u = _x[i + k];
+                        complex_type const v = _x[i + k + len / 2] * t;
+                        _x[i + k] = u + v;
+                        _x[i + k + len / 2] = u - v;
+                    }
+                }
+            }
+        }
+
+        inline bool IsPowerOfTwo(std::size_t _n)
+        {
+            return _n != 0 && (_n & (_n - 1)) == 0;
+        }
+    }
+
+    //-----------------------------------------------------------
+    //    Load
+    //        tables are shared by path while anything holds them,
+    //        the last SynthWT going frees the table
+    //-----------------------------------------------------------
+    std::shared_ptr<Wavetable const> Wavetable::Load(std::string const& _path)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::weak_ptr<Wavetable const>> tables;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::weak_ptr<Wavetable const>& entry = tables[_path];
+        std::shared_ptr<Wavetable const> table = entry.lock();
+        if(!table){
+            table.reset(new Wavetable(_path));
+            entry = table;
+        }
+        return table;
+    }
+
+    //-----------------------------------------------------------
+    //    Wavetable
+    //        the file is only mapped while the levels are built:
+    //        one forward transform per frame, then every level is
+    //        the inverse of the spectrum cut at its harmonics
+    //-----------------------------------------------------------
+    Wavetable::Wavetable(std::string const& _path)
+        : m_frames(0), m_levels(), m_data()
+    {
+        std::size_t const frame_size = Constants::wt_frame_size;
+        sykes::mapped_wav const wav(_path);
+
+        std::size_t cycle;
+        if(wav.frames() >= frame_size && wav.frames() % frame_size == 0){
+            cycle = frame_size;
+            m_frames = wav.frames() / frame_size;
+        }else if(IsPowerOfTwo(wav.frames()) && wav.frames() >= 4 && wav.frames() <= frame_size){
+            cycle = wav.frames();
+            m_frames = 1;
+        }else{
+            throw std::runtime_error("Wavetable: bad length of " + _path);
+        }
+
+        std::size_t offset = 0;
+        for(std::size_t h = frame_size / 4, size = frame_size; h != 0; h /= 2){
+            m_levels.push_back(Level{size, h, offset});
+            offset += m_frames * (size + 1);
+            if(size / 2 >= Constants::wt_min_level_size) size /= 2;
+        }
+        m_data.resize(offset);
+
+        std::vector<float> samples(cycle);
+        std::vector<complex_type> spectrum(cycle);
+        std::vector<complex_type> level;
+        for(std::size_t f = 0; f < m_frames; ++f){
+            wav.read(f * cycle, cycle, 0, &samples[0]);
+            for(std::size_t i = 0; i < cycle; ++i)
+                spectrum[i] = complex_type(samples[i], 0.0);
+            FFT(spectrum, -1.0);
+
+            for(std::size_t l = 0; l < m_levels.size(); ++l){
+                Level const& lv = m_levels[l];
+                std::size_t const top = std::min(lv.harmonics, cycle / 2 - 1);
+                level.assign(lv.size, complex_type());
+                level[0] = spectrum[0];
+                for(std::size_t k = 1; k <= top; ++k){
+                    level[k] = spectrum[k];
+                    level[lv.size - k] = spectrum[cycle - k];
+                }
+                FFT(level, 1.0);
+
+                float* const out = &m_data[lv.offset + f * (lv.size + 1)];
+                for(std::size_t i = 0; i < lv.size; ++i)
+                    out[i] = float(level[i].real() / double(cycle));
+                out[lv.size] = out[0];
+            }
+        }
+    }
+
+    std::size_t Wavetable::LevelFor(Real _cycles) const
+    {
+        std::size_t l = 0;
+        while(l + 1 < m_levels.size() && Real(m_levels[l].harmonics) * _cycles > 0.5) ++l;
+        return l;
+    }
+}//---- namespace
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------
+//    Wavetable
+//-----------------------------------------------------------
+#ifndef SYNTH_WAVETABLE_H
+#define SYNTH_WAVETABLE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "type.h"
+
+namespace TSynth{
+
+    //-----------------------------------------------------------
+    //    class Wavetable
+    //        the band-limited mip levels of a wavetable file, built
+    //        once and shared read-only by every SynthWT on the file.
+    //        a file of a multiple of Constants::wt_frame_size
+    //        samples holds that many frames, any other power of two
+    //        length up to it is one single cycle frame.
+    //        level L keeps the harmonics up to Harmonics(L), halving
+    //        from Constants::wt_frame_size / 4, in Size(L) samples;
+    //        the tables stay four times oversampled down to
+    //        Constants::wt_min_level_size.
+    //        each table is followed by a copy of its first sample so
+    //        the interpolation never wraps.
+    //-----------------------------------------------------------
+    class Wavetable
+    {
+    public:
+        // the table of _path, built on first use. throws
+        // std::runtime_error if the file cannot be read
+        static std::shared_ptr<Wavetable const> Load(std::string const& _path);
+
+        inline std::size_t Frames() const
+        { return m_frames; }
+
+        inline std::size_t Levels() const
+        { return m_levels.size(); }
+
+        inline std::size_t Size(std::size_t _level) const
+        { return m_levels[_level].size; }
+
+        inline std::size_t Harmonics(std::size_t _level) const
+        { return m_levels[_level].harmonics; }
+
+        // Size(_level) + 1 samples
+        inline float const* Table(std::size_t _level, std::size_t _frame) const
+        { return &m_data[m_levels[_level].offset + _frame * (m_levels[_level].size + 1)]; }
+
+        // the level for a fundamental of _cycles per sample: the one
+        // with the most harmonics that all stay below nyquist
+        std::size_t LevelFor(Real _cycles) const;
+
+    private:
+        struct Level
+        {
+            std::size_t size;
+            std::size_t harmonics;
+            std::size_t offset;
+        };
+
+        std::size_t m_frames;
+        std::vector<Level> m_levels;
+        std::vector<float> m_data;
+
+        explicit Wavetable(std::string const& _path);
+        Wavetable(Wavetable const&);
+        Wavetable& operator=(Wavetable const&);
+    };
+}//---- namespace
+
+#endif
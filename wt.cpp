@@ -0,0 +1,104 @@
+//-----------------------------------------------------------
+//    wt.cpp
+//-----------------------------------------------------------
+
+#include <cmath>
+#include "wt.h"
+
+namespace TSynth{
+    TSYNTH_DECLARE_NULLARY_MOD(SynthWT, (sykes::nocast(), StoD()))
+    
+    namespace{
+        ModParam const wt_params[] = {
+            {"tune", &ModParamGet<SynthWT, &SynthWT::GetTune>,
+                &ModParamSet<SynthWT, &SynthWT::SetTune>, true},
+            {"position", &ModParamGet<SynthWT, &SynthWT::GetPosition>,
+                &ModParamSet<SynthWT, &SynthWT::SetPosition>, true}
+        };
+    }
+    
+    ModParamList const SynthWT::params = {wt_params, sizeof(wt_params) / sizeof(wt_params[0])};
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    SynthWT::SynthWT(std::string const& _path, Real _position)
+        : m_table(Wavetable::Load(_path)),
+        m_frequency(Real(Constants::vco_default_frequency)),
+        m_tune(0.0),
+        m_tune_ratio(1.0),
+        m_position(0.0),
+        m_last_val(),
+        m_phase(),
+        m_delta_phase(),
+        m_sample_rate(SynthModBase::GetSampleRate()),
+        m_level(0),
+        m_size(),
+        m_table_a(),
+        m_table_b(),
+        m_crossfade()
+    {
+        SetPosition(_position);
+        SetFrequency(m_frequency);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthWT::SetFrequency(Real _f)
+    {
+        if(_f < Constants::vco_min_frequency)
+            m_frequency = Constants::vco_min_frequency;
+        else if(_f > Constants::vco_max_frequency)
+            m_frequency = Constants::vco_max_frequency;
+        else
+            m_frequency = _f;
+        m_delta_phase = m_frequency * m_tune_ratio / Real(m_sample_rate);
+        m_level = m_table->LevelFor(m_delta_phase);
+        SelectTables();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthWT::SetSampleRate(std::size_t _sr)
+    {
+        if(_sr == 0) return;
+        m_sample_rate = _sr;
+        SetFrequency(m_frequency);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthWT::SetTune(Real _semitones)
+    {
+        m_tune = _semitones;
+        m_tune_ratio = std::pow(2.0, _semitones / 12.0);
+        SetFrequency(m_frequency);
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthWT::SetPosition(Real _position)
+    {
+        m_position = (_position < 0.0) ? 0.0 : (_position > 1.0) ? 1.0 : _position;
+        SelectTables();
+    }
+    
+    //-----------------------------------------------------------
+    //    
+    //-----------------------------------------------------------
+    void SynthWT::SelectTables()
+    {
+        std::size_t const last = m_table->Frames() - 1;
+        Real const x = m_position * Real(last);
+        std::size_t const a = static_cast<std::size_t>(x);
+        std::size_t const b = (a < last) ? a + 1 : last;
+        m_crossfade = x - Real(a);
+        m_size = Real(m_table->Size(m_level));
+        m_table_a = m_table->Table(m_level, a);
+        m_table_b = m_table->Table(m_level, b);
+    }
+}//---- namespace
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------
+//    SynthWT
+//-----------------------------------------------------------
+#ifndef SYNTH_WT_H
+#define SYNTH_WT_H
+
+#include <memory>
+#include <string>
+#include "type.h"
+#include "constants.h"
+#include "synth_mod.h"
+#include "wavetable.h"
+
+namespace TSynth{
+    //-----------------------------------------------------------
+    //    class SynthWT
+    //        plays a Wavetable at the note. position sweeps the
+    //        frames from 0 to 1, neighbouring frames are crossfaded.
+    //        the mip level only changes with the frequency, so the
+    //        per sample work is two interpolated reads from tables
+    //        that stay in cache.
+    //-----------------------------------------------------------
+    class SynthWT : MidiReceivable
+    {
+    public:
+        typedef Real result_type;
+        static std::uint8_t const midi_mask =
+            sykes::midi::message_kind_bit(sykes::midi::CVMT::NOTE_ON);
+        static ModParamList const params;
+        
+        SynthWT(std::string const& _path, Real _position);
+        
+        inline Real operator()()
+        {
+            m_phase += m_delta_phase;
+            m_phase -= (m_phase >= 1.0) ? 1.0 : 0.0;
+            
+            Real const x = m_phase * m_size;
+            std::size_t const i = static_cast<std::size_t>(x);
+            Real const t = x - Real(i);
+            Real const a = m_table_a[i] + (m_table_a[i + 1] - m_table_a[i]) * t;
+            Real const b = m_table_b[i] + (m_table_b[i + 1] - m_table_b[i]) * t;
+            m_last_val = a + (b - a) * m_crossfade;
+            return m_last_val;
+        }
+        
+        void SetFrequency(Real _f);
+        
+        void SetSampleRate(std::size_t _sr);
+        
+        // offset from the note in semitones
+        void SetTune(Real _semitones);
+        
+        inline Real GetTune() const
+        { return m_tune; }
+        
+        // from 0, the first frame, to 1, the last
+        void SetPosition(Real _position);
+        
+        inline Real GetPosition() const
+        { return m_position; }
+        
+        inline Real GetLastVal() const
+        { return m_last_val; }
+        
+        inline void ResetPhase()
+        { m_phase = 0.0; }
+        
+        inline void MidiReceive(sykes::midi::message _m)
+        {
+            switch(sykes::midi::message::type(_m))
+            {
+                case sykes::midi::channel_voice_message_type::NOTE_ON:
+                {
+                    UInt8 note = sykes::midi::message::data1(_m);
+                    if(note < sykes::midi::note_table_size)
+                        SetFrequency(sykes::midi::note_table[note]);
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+    private:
+        void SelectTables();
+        
+        std::shared_ptr<Wavetable const> m_table;
+        Real m_frequency;
+        Real m_tune;
+        Real m_tune_ratio;
+        Real m_position;
+        Real m_last_val;
+        // in cycles
+        Real m_phase;
+        Real m_delta_phase;
+        std::size_t m_sample_rate;
+        std::size_t m_level;
+        Real m_size;
+        float const* m_table_a;
+        float const* m_table_b;
+        Real m_crossfade;
+        
+        TSYNTH_USE_AS_MOD
+    };
+}//---- namespace
+
+#endif